@@ -18,12 +18,14 @@ struct ID3D11RenderTargetView;
 struct ImFont;
 struct ImGuiContext;
 
+class Keybind;
+
 extern "C" __declspec(dllexport) void BaseCore_MockInit();
 
 class BaseCore
 {
 public:
-    static void Init(HMODULE dll, GW2Load_API& api);
+    static void Init(HMODULE dll, HMODULE gw2loadHandle, GW2Load_API& api);
     static void Shutdown();
 
     static LRESULT CALLBACK WndProc(HWND hWnd, UINT msg, WPARAM wParam, LPARAM lParam, UINT_PTR uIdSubclass, DWORD_PTR dwRefData);
@@ -56,6 +58,10 @@ public:
     [[nodiscard]] auto context() const { return context_; }
 
     [[nodiscard]] auto& languageChangeEvent() { return languageChangeEvent_.Downcast(); }
+    [[nodiscard]] auto& keybindLanguageChangeEvent() { return keybindLanguageChangeEvent_; }
+
+    // Events posted here are run from Update, on the render thread, once per frame
+    [[nodiscard]] EventQueue& deferredEvents() { return deferredEvents_; }
 
     ComPtr<ID3D11RenderTargetView>& backBufferRTV() { return backBufferRTV_; }
 
@@ -84,6 +90,9 @@ protected:
     virtual void InnerInitPostImGui() { }
     virtual void InnerShutdown() { }
     virtual void InnerInternalInit(GW2Load_API& api) { }
+    // Singletons added here are constructed during startup, see SingletonInitializer. Only those declaring ConcurrentInit
+    // run in parallel, the rest one at a time in dependency order.
+    virtual void InnerInitSingletons(SingletonInitializer& initializer) { }
     [[nodiscard]] virtual u32 GetShaderArchiveID() const = 0;
     [[nodiscard]] virtual const wchar_t* GetShaderDirectory() const = 0;
     [[nodiscard]] virtual const wchar_t* GetGithubRepoSubUrl() const = 0;
@@ -91,6 +100,7 @@ protected:
     virtual std::optional<LRESULT> OnInput(UINT msg, WPARAM& wParam, LPARAM& lParam) { return std::nullopt; }
 
     void InternalInit(HMODULE dll, GW2Load_API& api);
+    void InitSingletons();
     void InternalShutdown();
     void OnFocusLost();
     void OnFocus();
@@ -116,7 +126,9 @@ protected:
 
     using LanguageChangeEvent = Event<void()>;
 
-    LanguageChangeEvent languageChangeEvent_;
+    LanguageChangeEvent languageChangeEvent_ { "BaseCore::languageChangeEvent" };
+    IntrusiveEvent<Keybind> keybindLanguageChangeEvent_;
+    EventQueue deferredEvents_;
 
     ImGuiContext* imguiContext_ = nullptr;
 
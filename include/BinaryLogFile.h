@@ -0,0 +1,54 @@
+#pragma once
+#include <filesystem>
+#include <fstream>
+#include <map>
+#include <thread>
+
+#include "Common.h"
+#include "LogFileFormat.h"
+
+enum class Severity : uint8_t;
+namespace LogDetail
+{
+struct Formatter;
+}
+
+// Writer for the binary log format described in LogFileFormat.h. Segments are rotated once they exceed
+// maxSegmentSize, rotated segments are zipped in the background and only the latest maxSegments archives are kept.
+// Only used from the log writer thread.
+class BinaryLogFile
+{
+public:
+    static constexpr u64 DefaultSegmentSize = 16 * 1024 * 1024;
+    static constexpr u32 DefaultMaxSegments = 8;
+
+    BinaryLogFile(std::filesystem::path path, u64 maxSegmentSize = DefaultSegmentSize, u32 maxSegments = DefaultMaxSegments);
+    ~BinaryLogFile();
+
+    [[nodiscard]] bool isOpen() const { return file_.is_open(); }
+
+    void WriteMessage(i64 time, Severity sev, const LogDetail::Formatter& formatter, const void* fmt, size_t fmtSize, std::string_view payload);
+    void WriteText(i64 time, Severity sev, std::string_view text);
+    void Flush();
+
+private:
+    void Open();
+    void Rotate();
+    void PruneSegments() const;
+    u32 FormatId(const LogDetail::Formatter& formatter, const void* fmt, size_t fmtSize);
+    void Write(const void* data, size_t size);
+
+    std::filesystem::path path_;
+    u64 maxSegmentSize_;
+    u32 maxSegments_;
+    std::string session_;
+    u32 rotations_ = 0;
+
+    std::ofstream file_;
+    u64 size_ = 0;
+    // Pushed back when the segment could not be moved aside, it is kept growing until a retry succeeds
+    u64 rotateAt_ = 0;
+    // Identical literals may be pooled, so the same format string can come with several argument type lists
+    std::map<std::pair<const void*, const LogDetail::Formatter*>, u32> formatIds_;
+    std::jthread compressor_;
+};
@@ -38,6 +38,12 @@ protected:
     [[nodiscard]] virtual bool test(const ConditionContext& cc) const = 0;
 
     std::string paramName(const char* param) const { return "condition_" + std::to_string(id_) + "_" + nickname() + "_" + param; }
+    // A condition never changes sets, so its keys are resolved on first use and kept
+    ConfigKey paramKey(ConfigKey& key, const char* category, const char* param, ConfigType type) const {
+        if(!key.valid())
+            key = INIConfigurationFile::i().Resolve(category, paramName(param), type);
+        return key;
+    }
 
     [[nodiscard]] virtual bool DrawInnerMenu() = 0;
 
@@ -57,14 +63,13 @@ public:
 
     [[nodiscard]] bool passes(const ConditionContext& cc) const { return test(cc) != negate_; }
 
-    virtual void Save(const char* category) const {
-        INIConfigurationFile::i().ini().SetBoolValue(category, paramName("negate").c_str(), negate_);
-    }
-    virtual void Load(const char* category) {
-        negate_ = INIConfigurationFile::i().ini().GetBoolValue(category, paramName("negate").c_str(), false);
-    }
+    virtual void Save(const char* category) const { INIConfigurationFile::i().SetBool(paramKey(negateKey_, category, "negate", ConfigType::Bool), negate_); }
+    virtual void Load(const char* category) { negate_ = INIConfigurationFile::i().GetBool(paramKey(negateKey_, category, "negate", ConfigType::Bool), false); }
 
     [[nodiscard]] bool DrawMenu(const char* category, MenuResult& mr, bool isFirst, bool isLast);
+
+private:
+    mutable ConfigKey negateKey_;
 };
 
 class IsInCombatCondition final : public Condition
@@ -120,6 +125,7 @@ public:
 
 private:
     MumbleLink::Profession profession_;
+    mutable ConfigKey idKey_;
 
     [[nodiscard]] bool test(const ConditionContext& cc) const override { return cc.profession == profession_; }
     [[nodiscard]] std::string nickname() const override { return Nickname; }
@@ -132,12 +138,11 @@ public:
 
     void Save(const char* category) const override {
         Condition::Save(category);
-        INIConfigurationFile::i().ini().SetLongValue(category, paramName("id").c_str(), static_cast<long>(profession_));
+        INIConfigurationFile::i().SetInt(paramKey(idKey_, category, "id", ConfigType::Int), static_cast<i64>(profession_));
     }
     void Load(const char* category) override {
         Condition::Load(category);
-        profession_ =
-            static_cast<MumbleLink::Profession>(INIConfigurationFile::i().ini().GetLongValue(category, paramName("id").c_str(), 0));
+        profession_ = static_cast<MumbleLink::Profession>(INIConfigurationFile::i().GetInt(paramKey(idKey_, category, "id", ConfigType::Int), 0));
     }
 };
 
@@ -149,6 +154,7 @@ public:
 
 private:
     MumbleLink::EliteSpec elitespec_;
+    mutable ConfigKey idKey_;
 
     [[nodiscard]] bool test(const ConditionContext& cc) const override { return cc.elitespec == elitespec_; }
     [[nodiscard]] std::string nickname() const override { return Nickname; }
@@ -161,11 +167,11 @@ public:
 
     void Save(const char* category) const override {
         Condition::Save(category);
-        INIConfigurationFile::i().ini().SetLongValue(category, paramName("id").c_str(), static_cast<long>(elitespec_));
+        INIConfigurationFile::i().SetInt(paramKey(idKey_, category, "id", ConfigType::Int), static_cast<i64>(elitespec_));
     }
     void Load(const char* category) override {
         Condition::Load(category);
-        elitespec_ = static_cast<MumbleLink::EliteSpec>(INIConfigurationFile::i().ini().GetLongValue(category, paramName("id").c_str(), 0));
+        elitespec_ = static_cast<MumbleLink::EliteSpec>(INIConfigurationFile::i().GetInt(paramKey(idKey_, category, "id", ConfigType::Int), 0));
     }
 };
 
@@ -177,6 +183,7 @@ public:
 
 private:
     std::wstring characterName_;
+    mutable ConfigKey charnameKey_;
 
     [[nodiscard]] bool test(const ConditionContext& cc) const override {
         return ToCaseInsensitive(cc.character) == ToCaseInsensitive(characterName_);
@@ -192,11 +199,11 @@ public:
 
     void Save(const char* category) const override {
         Condition::Save(category);
-        INIConfigurationFile::i().ini().SetValue(category, paramName("charname").c_str(), utf8_encode(characterName_).c_str());
+        INIConfigurationFile::i().SetString(paramKey(charnameKey_, category, "charname", ConfigType::Text), utf8_encode(characterName_));
     }
     void Load(const char* category) override {
         Condition::Load(category);
-        characterName_ = utf8_decode(INIConfigurationFile::i().ini().GetValue(category, paramName("charname").c_str(), ""));
+        characterName_ = utf8_decode(INIConfigurationFile::i().GetString(paramKey(charnameKey_, category, "charname", ConfigType::Text), ""));
     }
 };
 
@@ -217,6 +224,7 @@ struct ConditionEntry
 class ConditionSet
 {
     std::string category_;
+    ConfigKey setKey_;
 
     std::list<ConditionEntry> conditions_;
 
@@ -1,15 +1,32 @@
 #pragma once
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <optional>
+#include <span>
+#include <thread>
+#include <unordered_map>
+#include <variant>
+
 #include <SimpleIni.h>
 #include <nlohmann/json.hpp>
 
 #include "Common.h"
+#include "Event.h"
+#include "FileWatcher.h"
 #include "Singleton.h"
 
 class ConfigurationFile
 {
 public:
+    virtual ~ConfigurationFile();
+
     virtual void Reload();
     virtual void Save();
+    // Applies edits made to the file by other programs, which the file watcher flagged in the meantime
+    virtual void OnUpdate();
 
     const std::string& lastSaveError() const { return lastSaveError_; }
     bool lastSaveErrorChanged() const { return lastSaveErrorChanged_; }
@@ -22,30 +39,261 @@ public:
 
 protected:
     virtual const std::wstring_view configFileName() const = 0;
+    virtual void ApplyExternalChanges() = 0;
+    void WatchFile();
 
     std::optional<std::filesystem::path> folder_;
     bool readOnly_ = false;
     bool readOnlyWarned_ = false;
 
+    std::optional<u32> watch_;
+    std::atomic<bool> externalChange_ = false;
+    // Of the file as last read or written by us, so that our own writes are not mistaken for external edits
+    u64 diskHash_ = 0;
+
     bool lastSaveErrorChanged_ = false;
     std::string lastSaveError_;
 };
 
+// Declared type of a value in the INI configuration table, which is parsed as such right away when the file is loaded.
+// Text values are kept as read and other types are parsed on first access.
+enum class ConfigType : u8
+{
+    Text,
+    Bool,
+    Int,
+    Double
+};
+
+// Moves config.ini from an older layout to the next version. Migrations are grouped by scope, each scope's version is
+// stored in the ConfigVersions section and its migrations run once, in order, for files older than their version.
+struct ConfigMigration
+{
+    std::string scope;
+    u32 version;
+    std::function<void(CSimpleIniA& ini)> migrate;
+};
+
+// Handle to one value of the INI configuration table, resolved once from its section and key names
+class ConfigKey
+{
+public:
+    ConfigKey() = default;
+
+    [[nodiscard]] bool valid() const { return index_ != Invalid; }
+
+private:
+    static constexpr u32 Invalid = ~0u;
+
+    explicit ConfigKey(u32 index) : index_(index) { }
+
+    u32 index_ = Invalid;
+
+    friend class INIConfigurationFile;
+};
+
 class INIConfigurationFile : public ConfigurationFile, public Singleton<INIConfigurationFile>
 {
     CSimpleIniA ini_;
     static const std::wstring_view ConfigFileName;
     const std::wstring_view configFileName() const override { return ConfigFileName; }
-    static void LoadImGuiSettings(const std::wstring& location);
-    static void SaveImGuiSettings(const std::wstring& location);
+    void LoadImGuiSettings(const std::filesystem::path& location);
+    void SaveImGuiSettings(const std::filesystem::path& location);
 
 public:
+    using Dependencies = SingletonDependencies<FileWatcher>;
+    static constexpr bool ConcurrentInit = true;
+    using ChangeCallback = std::function<void()>;
+
+    // Saves only mark the file dirty, it is written once no further change came in for SaveDebounce (or at most
+    // SaveMaxDelay after the first one) by a background thread
+    static constexpr std::chrono::milliseconds SaveDebounce { 500 };
+    static constexpr std::chrono::milliseconds SaveMaxDelay { 5000 };
+    // Changed table values are appended to config.ini.journal, the INI itself is only rewritten once the journal
+    // reaches this size
+    static constexpr size_t JournalCompactSize = 64 * 1024;
+
     INIConfigurationFile();
-    CSimpleIniA& ini() { return ini_; }
+    ~INIConfigurationFile();
+    // Values accessed through a ConfigKey live in the table and are only written back to the INI when saving. Changes
+    // made here directly cannot be journaled, so the next save rewrites the whole file.
+    CSimpleIniA& ini() {
+        iniModified_ = true;
+        unclaimedStale_ = true;
+        return ini_;
+    }
+    const CSimpleIniA& ini() const { return ini_; }
+
+    // Finds or adds the table entry for a value, handles stay valid across reloads
+    [[nodiscard]] ConfigKey Resolve(std::string_view section, std::string_view key, ConfigType type = ConfigType::Text);
+
+    // Migrations have to be registered before the configuration is first loaded, returns true so that it can be used
+    // to initialize a static
+    static bool RegisterMigration(ConfigMigration migration);
+
+    [[nodiscard]] bool GetBool(ConfigKey key, bool defaultValue);
+    [[nodiscard]] i64 GetInt(ConfigKey key, i64 defaultValue);
+    [[nodiscard]] double GetDouble(ConfigKey key, double defaultValue);
+    // Points into the table, valid only until the value is next set, overridden or reloaded, copy it to keep it
+    [[nodiscard]] const char* GetString(ConfigKey key, const char* defaultValue);
+
+    void SetBool(ConfigKey key, bool value) { Set(key, value); }
+    void SetInt(ConfigKey key, i64 value) { Set(key, value); }
+    void SetDouble(ConfigKey key, double value) { Set(key, value); }
+    void SetString(ConfigKey key, std::string_view value) { Set(key, std::string(value)); }
+    void Erase(ConfigKey key) { Set(key, std::monostate {}); }
+
+    // Per-character profiles override table values for one character, everything else keeps the account-wide value.
+    // Overrides are stored in the INI as "section@character" sections. Switching profiles only swaps the active
+    // override layer, then runs the change callbacks of the values overridden on either side.
+    void profile(std::string_view character);
+    [[nodiscard]] const std::string& profile() const { return profile_; }
+    // Bumped on every profile switch, for caches of values derived from the table
+    [[nodiscard]] u32 profileGeneration() const { return profileGeneration_; }
+
+    [[nodiscard]] bool IsOverridden(ConfigKey key) const { return activeLayer_->values.contains(key.index_); }
+    // Makes the value specific to the active character, starting out from the account-wide one. Sets then only change
+    // the override until it is cleared again.
+    void Override(ConfigKey key);
+    void ClearOverride(ConfigKey key);
+
+    // Called from OnUpdate when an external edit of config.ini or a profile switch changed the value, which is already
+    // applied to the table
+    [[nodiscard]] EventCallbackHandle AddChangeCallback(ConfigKey key, ChangeCallback callback);
+    void RemoveChangeCallback(ConfigKey key, EventCallbackHandle&& handle);
 
     void Reload() override;
     void Save() override;
-    void OnUpdate() const;
+    // Writes any pending changes right away and waits for them to reach the disk
+    void Flush();
+    void OnUpdate() override;
+
+protected:
+    void ApplyExternalChanges() override;
+
+private:
+    struct WriteJob
+    {
+        enum class Kind : u8
+        {
+            Append,  // text holds journal records
+            Compact, // text holds the whole file, which replaces the INI and journal
+            Rebase,  // text holds the whole file as already on disk, the journal is empty
+            Replace  // text holds any other file, which is replaced as is
+        };
+
+        Kind kind;
+        std::filesystem::path path;
+        std::string text;
+        // Hash of the INI on disk the journal applies to, for Rebase
+        u64 baseHash = 0;
+    };
+
+    // Text is what was read from the INI, it is parsed and replaced with the requested type on first access
+    struct Text
+    {
+        std::string value;
+    };
+    using Value = std::variant<std::monostate, Text, bool, i64, double, std::string>;
+
+    // Overrides of one character, characters without any all use the same empty layer
+    struct ProfileLayer
+    {
+        std::unordered_map<u32, Value> values;
+    };
+
+    struct Entry
+    {
+        std::string section, key;
+        Value value;
+        ConfigType type = ConfigType::Text;
+        bool dirty = false;
+        std::vector<std::pair<i32, ChangeCallback>> callbacks;
+    };
+
+    static std::vector<ConfigMigration>& migrations();
+
+    void Set(ConfigKey key, Value value);
+    // The active character's override if there is one, the account-wide value otherwise
+    [[nodiscard]] Value& value(ConfigKey key);
+    [[nodiscard]] static Value ParseValue(ConfigType type, const char* text);
+    void LoadEntry(Entry& e) const;
+    // Creates the character's layer on first use
+    ProfileLayer& MutableLayer(const std::string& character);
+    void MarkOverrideDirty(const std::string& character, u32 index);
+    void StoreValue(const char* section, const char* key, const Value& value);
+    void RunChangeCallbacks(std::span<const u32> indices);
+    // Hands every value in the INI to its entry in a single pass over the file
+    void LoadEntries();
+    // Indexes the values no entry is registered for by name, so that resolving never searches the INI. Also loads the
+    // registered entries on the same pass if asked to.
+    void IndexValues(bool loadEntries);
+    // Hands the indexed values of a newly registered entry over to it
+    void Claim(u32 index, const std::string& name);
+    // Returns whether any migration changed the INI
+    bool RunMigrations();
+    // Writes changed entries back to the INI and returns them as journal records
+    [[nodiscard]] std::string StoreDirtyEntries();
+
+    [[nodiscard]] std::optional<std::string> Serialize();
+    void QueueChanges();
+    void Queue(WriteJob job);
+    void CollectWriteResult();
+    void SaveError(std::string error);
+    void WriterLoop(std::stop_token stop);
+    // Runs all pending jobs with writing_ set, the lock is released in the meantime
+    void RunJobs(std::unique_lock<std::mutex>& lock);
+    [[nodiscard]] std::string RunJob(WriteJob& job);
+
+    // Deque so entries never move, string values are handed out by pointer until they change
+    std::deque<Entry> entries_;
+    std::unordered_map<std::string, u32> entryIndices_;
+    std::vector<u32> dirtyEntries_;
+    i32 nextCallbackId_ = 0;
+
+    // Values in the INI which no entry was resolved for yet, by entry name, as text and per-character overrides
+    struct UnclaimedValue
+    {
+        std::optional<std::string> text;
+        std::vector<std::pair<std::string, std::string>> overrides;
+    };
+    std::unordered_map<std::string, UnclaimedValue> unclaimed_;
+    // Set when the INI changed other than through the table, the index is rebuilt on the next resolve
+    bool unclaimedStale_ = false;
+
+    std::unordered_map<std::string, ProfileLayer> profiles_;
+    ProfileLayer emptyLayer_;
+    ProfileLayer* activeLayer_ = &emptyLayer_;
+    std::string profile_;
+    u32 profileGeneration_ = 0;
+    std::vector<std::pair<std::string, u32>> dirtyOverrides_;
+
+    std::optional<std::chrono::steady_clock::time_point> dirtySince_;
+    std::chrono::steady_clock::time_point saveDeadline_;
+    bool iniModified_ = false;
+    // The INI as last read or written by us, external edits are diffed against it
+    std::string diskContents_;
+    // Of the ImGui settings last loaded or saved, ImGui asks for a save whenever a window moves even if nothing changed
+    u64 imguiHash_ = 0;
+
+    // Shared with the writer thread
+    std::mutex writerMutex_;
+    std::condition_variable_any writerCv_;
+    std::vector<WriteJob> pendingJobs_;
+    bool writing_ = false;
+    // Error message of the last completed write, empty on success
+    std::optional<std::string> writeResult_;
+    // Contents of the INI if the last jobs rewrote it
+    std::optional<std::string> writtenContents_;
+
+    // Owned by whoever set writing_: the INI as it is on disk with the journal applied, so compaction needs nothing
+    // from the main thread
+    CSimpleIniA journaled_;
+    u64 journalBaseHash_ = 0;
+    size_t journalSize_ = 0;
+    std::optional<std::string> written_;
+
+    std::jthread writer_;
 };
 
 class JSONConfigurationFile : public ConfigurationFile, public Singleton<JSONConfigurationFile>
@@ -55,9 +303,21 @@ class JSONConfigurationFile : public ConfigurationFile, public Singleton<JSONCon
     const std::wstring_view configFileName() const override { return ConfigFileName; }
 
 public:
+    using Dependencies = SingletonDependencies<FileWatcher>;
+    static constexpr bool ConcurrentInit = true;
+    // Raised from OnUpdate for every value an external edit of config.json added, removed or changed
+    using ExternalChangeEvent = Event<void(const nlohmann::json::json_pointer&), const nlohmann::json::json_pointer&>;
+
     JSONConfigurationFile();
     nlohmann::json& json() { return json_; }
+    [[nodiscard]] ExternalChangeEvent& externalChangeEvent() { return externalChangeEvent_; }
 
     void Reload() override;
     void Save() override;
+
+protected:
+    void ApplyExternalChanges() override;
+
+private:
+    ExternalChangeEvent externalChangeEvent_ { "JSONConfigurationFile::externalChangeEvent" };
 };
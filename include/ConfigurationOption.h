@@ -1,5 +1,7 @@
 #pragma once
+#include <string>
 #include <type_traits>
+#include <variant>
 
 #include "Common.h"
 #include "ConfigurationFile.h"
@@ -10,15 +12,34 @@ class ConfigurationOption
 public:
     ConfigurationOption(std::string_view displayName, std::string_view nickname, std::string_view category, T defaultValue = T())
         : displayName_(displayName), nickname_(nickname), category_(category), value_(defaultValue) {
+        key_ = INIConfigurationFile::i().Resolve(category_, nickname_, Type);
         LoadValue();
+        Subscribe();
     }
-    ConfigurationOption(ConfigurationOption&&) = default;
+    // The change callback captures this, so the moved-from option keeps its own until destroyed
+    ConfigurationOption(ConfigurationOption&& other)
+        : displayName_(std::move(other.displayName_)), nickname_(std::move(other.nickname_)), category_(std::move(other.category_)),
+          key_(other.key_), value_(std::move(other.value_)) {
+        if constexpr(std::is_same_v<T, const char *>) {
+            if(value_ == other.text_.c_str()) {
+                text_ = std::move(other.text_);
+                value_ = text_.c_str();
+            }
+        }
+        Subscribe();
+    }
+    ~ConfigurationOption() { Unsubscribe(); }
 
     const std::string &displayName() const { return displayName_; }
     void displayName(const std::string &displayName) { displayName_ = displayName; }
 
     const std::string &category() const { return category_; }
-    void category(const std::string &category) { category_ = category; }
+    void category(const std::string &category) {
+        Unsubscribe();
+        category_ = category;
+        key_ = INIConfigurationFile::i().Resolve(category_, nickname_, Type);
+        Subscribe();
+    }
 
     const T &value() const { return value_; }
     T &value() { return value_; }
@@ -29,57 +50,95 @@ public:
 
     void Reload() { LoadValue(); }
 
+    // Whether the value is specific to the current character's profile
+    [[nodiscard]] bool overridden() const { return INIConfigurationFile::i().IsOverridden(key_); }
+    void overridden(bool overridden) {
+        auto& cfg = INIConfigurationFile::i();
+        if(overridden) {
+            SaveValue();
+            cfg.Override(key_);
+        }
+        else {
+            cfg.ClearOverride(key_);
+            LoadValue();
+        }
+        cfg.Save();
+    }
+
     void ForceSave() const {
         SaveValue();
         INIConfigurationFile::i().Save();
     }
 
 protected:
-    void LoadValue() {
-        if constexpr(std::is_same_v<T, i32>)
-            value_ = INIConfigurationFile::i().ini().GetLongValue(category_.c_str(), nickname_.c_str(), value());
-        else if constexpr(std::is_same_v<T, i16>)
-            value_ = static_cast<i16>(INIConfigurationFile::i().ini().GetLongValue(category_.c_str(), nickname_.c_str(), value()));
-        else if constexpr(std::is_same_v<T, double>)
-            value_ = INIConfigurationFile::i().ini().GetDoubleValue(category_.c_str(), nickname_.c_str(), value());
-        else if constexpr(std::is_same_v<T, f32>)
-            value_ = f32(INIConfigurationFile::i().ini().GetDoubleValue(category_.c_str(), nickname_.c_str(), value()));
-        else if constexpr(std::is_same_v<T, bool>)
-            value_ = INIConfigurationFile::i().ini().GetBoolValue(category_.c_str(), nickname_.c_str(), value());
+    static constexpr ConfigType Type = [] {
+        if constexpr(std::is_same_v<T, bool>)
+            return ConfigType::Bool;
+        else if constexpr(std::is_same_v<T, double> || std::is_same_v<T, f32>)
+            return ConfigType::Double;
         else if constexpr(std::is_same_v<T, const char *>)
-            value_ = INIConfigurationFile::i().ini().GetValue(category_.c_str(), nickname_.c_str(), value());
+            return ConfigType::Text;
+        else
+            return ConfigType::Int;
+    }();
+
+    // Picks up external edits of the config file
+    void Subscribe() { changeCallback_ = INIConfigurationFile::i().AddChangeCallback(key_, [this] { LoadValue(); }); }
+    void Unsubscribe() {
+        INIConfigurationFile::f([&](INIConfigurationFile& cfg) { cfg.RemoveChangeCallback(key_, std::move(changeCallback_)); });
+        changeCallback_ = {};
+    }
+
+    void LoadValue() {
+        auto& cfg = INIConfigurationFile::i();
+        if constexpr(std::is_same_v<T, bool>)
+            value_ = cfg.GetBool(key_, value());
+        else if constexpr(std::is_same_v<T, i32> || std::is_same_v<T, i16>)
+            value_ = static_cast<T>(cfg.GetInt(key_, value()));
+        else if constexpr(std::is_same_v<T, double> || std::is_same_v<T, f32>)
+            value_ = static_cast<T>(cfg.GetDouble(key_, value()));
+        else if constexpr(std::is_same_v<T, const char *>) {
+            // The table's string goes away on the next set or reload, so the option keeps its own copy
+            if(const char* text = cfg.GetString(key_, value())) {
+                std::string copy(text); // May be the current text_ itself
+                text_ = std::move(copy);
+                value_ = text_.c_str();
+            }
+            else
+                value_ = nullptr;
+        }
         else if constexpr(std::is_enum_v<T> && sizeof(T) <= sizeof(i32))
-            value_ = static_cast<T>(
-                INIConfigurationFile::i().ini().GetLongValue(category_.c_str(), nickname_.c_str(), static_cast<i32>(value())));
+            value_ = static_cast<T>(cfg.GetInt(key_, static_cast<i32>(value())));
         else if constexpr(std::is_union_v<T> && sizeof(T) <= sizeof(i32))
-            value_.value = INIConfigurationFile::i().ini().GetLongValue(category_.c_str(), nickname_.c_str(), value().value);
+            value_.value = static_cast<decltype(value_.value)>(cfg.GetInt(key_, value().value));
         else
             static_assert(!sizeof(T), "Unsupported value type");
     }
 
     void SaveValue() const {
-        if constexpr(std::is_same_v<T, i32>)
-            INIConfigurationFile::i().ini().SetLongValue(category_.c_str(), nickname_.c_str(), value());
-        else if constexpr(std::is_same_v<T, i16>)
-            INIConfigurationFile::i().ini().SetLongValue(category_.c_str(), nickname_.c_str(), value());
-        else if constexpr(std::is_same_v<T, double>)
-            INIConfigurationFile::i().ini().SetDoubleValue(category_.c_str(), nickname_.c_str(), value());
-        else if constexpr(std::is_same_v<T, f32>)
-            INIConfigurationFile::i().ini().SetDoubleValue(category_.c_str(), nickname_.c_str(), double(value()));
-        else if constexpr(std::is_same_v<T, bool>)
-            INIConfigurationFile::i().ini().SetBoolValue(category_.c_str(), nickname_.c_str(), value());
+        auto& cfg = INIConfigurationFile::i();
+        if constexpr(std::is_same_v<T, bool>)
+            cfg.SetBool(key_, value());
+        else if constexpr(std::is_same_v<T, i32> || std::is_same_v<T, i16>)
+            cfg.SetInt(key_, value());
+        else if constexpr(std::is_same_v<T, double> || std::is_same_v<T, f32>)
+            cfg.SetDouble(key_, double(value()));
         else if constexpr(std::is_same_v<T, const char *>)
-            INIConfigurationFile::i().ini().SetValue(category_.c_str(), nickname_.c_str(), value());
+            cfg.SetString(key_, value());
         else if constexpr(std::is_enum_v<T> && sizeof(T) <= sizeof(i32))
-            INIConfigurationFile::i().ini().SetLongValue(category_.c_str(), nickname_.c_str(), static_cast<i32>(value()));
+            cfg.SetInt(key_, static_cast<i32>(value()));
         else if constexpr(std::is_union_v<T> && sizeof(T) <= sizeof(i32))
-            INIConfigurationFile::i().ini().SetLongValue(category_.c_str(), nickname_.c_str(), value().value);
+            cfg.SetInt(key_, value().value);
         else
             static_assert(!sizeof(T), "Unsupported value type");
     }
 
     std::string displayName_, nickname_, category_;
+    ConfigKey key_;
     T value_;
+    // Owns what value_ points to once loaded, for string options only
+    [[no_unique_address]] std::conditional_t<std::is_same_v<T, const char *>, std::string, std::monostate> text_;
+    EventCallbackHandle changeCallback_;
 };
 
 namespace ImGui
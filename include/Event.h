@@ -1,7 +1,13 @@
 #pragma once
 
 #include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <execution>
 #include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
 #include <vector>
 
 #include <range/v3/all.hpp>
@@ -21,9 +27,97 @@ public:
     i32 id() const { return id_; }
 };
 
+enum class EventDispatch
+{
+    Serial,
+    // The callback is thread-safe and independent from other callbacks of the same priority,
+    // so it may run on a worker thread concurrently with them (void events only)
+    Parallel
+};
+
+struct EventCallbackStats
+{
+    std::atomic<u64> calls = 0;
+    std::atomic<u64> totalNs = 0;
+    std::atomic<u64> maxNs = 0;
+
+    void Record(u64 ns) {
+        calls.fetch_add(1, std::memory_order_relaxed);
+        totalNs.fetch_add(ns, std::memory_order_relaxed);
+        u64 prevMax = maxNs.load(std::memory_order_relaxed);
+        while(prevMax < ns && !maxNs.compare_exchange_weak(prevMax, ns, std::memory_order_relaxed)) { }
+    }
+
+    void Reset() {
+        calls = 0;
+        totalNs = 0;
+        maxNs = 0;
+    }
+};
+
+class EventCallbackTimer
+{
+public:
+    explicit EventCallbackTimer(EventCallbackStats& stats) : stats_(stats), start_(std::chrono::steady_clock::now()) { }
+    ~EventCallbackTimer() { stats_.Record(u64(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start_).count())); }
+
+private:
+    EventCallbackStats& stats_;
+    std::chrono::steady_clock::time_point start_;
+};
+
+// Type-erased view of every live event, used to report per-callback timings when profiling is enabled
+class ProfiledEvent
+{
+public:
+    struct CallbackInfo
+    {
+        i32 id;
+        i32 priority;
+        const std::string& debugName;
+        const EventCallbackStats& stats;
+    };
+
+    ProfiledEvent(const ProfiledEvent&) = delete;
+    ProfiledEvent(ProfiledEvent&&) = delete;
+    ProfiledEvent& operator=(const ProfiledEvent&) = delete;
+    ProfiledEvent& operator=(ProfiledEvent&&) = delete;
+
+    [[nodiscard]] const std::string& debugName() const { return debugName_; }
+    void debugName(std::string name) { debugName_ = std::move(name); }
+
+    virtual void VisitCallbacks(const std::function<void(const CallbackInfo&)>& visitor) const = 0;
+    virtual void ResetStats() = 0;
+
+    [[nodiscard]] static bool profilingEnabled() { return profilingEnabled_.load(std::memory_order_relaxed); }
+    static void profilingEnabled(bool enabled) { profilingEnabled_ = enabled; }
+
+    static void ForEach(const std::function<void(ProfiledEvent&)>& action) {
+        std::lock_guard guard { registryMutex_ };
+        for(auto* e : registry_)
+            action(*e);
+    }
+
+protected:
+    ProfiledEvent() {
+        std::lock_guard guard { registryMutex_ };
+        registry_.push_back(this);
+    }
+    virtual ~ProfiledEvent() {
+        std::lock_guard guard { registryMutex_ };
+        std::erase(registry_, this);
+    }
+
+    std::string debugName_;
+
+    inline static std::atomic<bool> profilingEnabled_ = false;
+    inline static std::mutex registryMutex_;
+    inline static std::vector<ProfiledEvent*> registry_;
+};
+
 template<typename Func, typename... Args>
     requires std::invocable<Func, Args...>
-class EventBase
+class EventBase : public ProfiledEvent
 {
 public:
     using CallbackType = std::function<Func>;
@@ -34,10 +128,19 @@ public:
     EventBase& operator=(const EventBase&) = delete;
     EventBase& operator=(EventBase&&) = delete;
 
-    EventCallbackHandle AddCallback(CallbackType function, i32 priority = 0) {
-        callbacks_.push_back({ callbackNextID_++, priority, std::move(function) });
+    EventCallbackHandle AddCallback(CallbackType function, i32 priority = 0, EventDispatch dispatch = EventDispatch::Serial) {
+        return AddCallback({}, std::move(function), priority, dispatch);
+    }
+
+    // The debug name identifies the callback in profiling reports
+    EventCallbackHandle AddCallback(std::string debugName, CallbackType function, i32 priority = 0,
+                                    EventDispatch dispatch = EventDispatch::Serial) {
+        const i32 id = callbackNextID_++;
+        callbacks_.push_back({ id, priority, dispatch, std::move(function), std::move(debugName), std::make_unique<EventCallbackStats>() });
         ranges::sort(callbacks_, [](auto& a, auto& b) { return a.priority > b.priority; });
-        return { callbacks_.back().id };
+        if(dispatch == EventDispatch::Parallel)
+            parallelCallbackCount_++;
+        return { id };
     }
 
     void RemoveCallback(EventCallbackHandle&& id) {
@@ -45,8 +148,21 @@ public:
             return;
 
         auto it = ranges::find_if(callbacks_, [&id](auto& cb) { return cb.id == id.id(); });
-        if(it != callbacks_.end())
+        if(it != callbacks_.end()) {
+            if(it->dispatch == EventDispatch::Parallel)
+                parallelCallbackCount_--;
             callbacks_.erase(it);
+        }
+    }
+
+    void VisitCallbacks(const std::function<void(const CallbackInfo&)>& visitor) const override {
+        for(const auto& cb : callbacks_)
+            visitor({ cb.id, cb.priority, cb.debugName, *cb.stats });
+    }
+
+    void ResetStats() override {
+        for(auto& cb : callbacks_)
+            cb.stats->Reset();
     }
 
 protected:
@@ -54,10 +170,23 @@ protected:
     {
         i32 id;
         i32 priority;
+        EventDispatch dispatch;
         CallbackType callback;
+        std::string debugName;
+        std::unique_ptr<EventCallbackStats> stats;
     };
 
+    template<typename... CallArgs>
+    static decltype(auto) Invoke(const Callback& cb, CallArgs&&... args) {
+        if(!profilingEnabled()) [[likely]]
+            return cb.callback(std::forward<CallArgs>(args)...);
+
+        EventCallbackTimer timer(*cb.stats);
+        return cb.callback(std::forward<CallArgs>(args)...);
+    }
+
     i32 callbackNextID_ = 0;
+    i32 parallelCallbackCount_ = 0;
     std::vector<Callback> callbacks_;
 };
 
@@ -82,15 +211,21 @@ public:
 
     Event(CombineFunc combine) : combine_(std::move(combine)) { }
 
+    explicit Event(std::string debugName, CombineFunc combine = std::logical_or<ReturnType> {}) : combine_(std::move(combine)) {
+        this->debugName(std::move(debugName));
+    }
+
     DowncastType& Downcast() { return *this; }
 
     ReturnType operator()(Args... args) {
         if(this->callbacks_.empty())
             return {};
 
-        ReturnType rval = this->callbacks_[0].callback(std::forward<Args>(args)...);
-        for(size_t i = 1; i < this->callbacks_.size(); i++)
-            rval = combine_(rval, this->callbacks_[i].callback(std::forward<Args>(args)...));
+        ReturnType rval = this->Invoke(this->callbacks_[0], std::forward<Args>(args)...);
+        for(size_t i = 1; i < this->callbacks_.size(); i++) {
+            ReturnType r = this->Invoke(this->callbacks_[i], std::forward<Args>(args)...);
+            rval = combine_(rval, r);
+        }
 
         return rval;
     }
@@ -112,13 +247,223 @@ public:
 
     Event() = default;
 
+    explicit Event(std::string debugName) { this->debugName(std::move(debugName)); }
+
     DowncastType& Downcast() { return *this; }
 
     void operator()(Args... args) {
         if(this->callbacks_.empty())
             return;
 
+        if constexpr(CanDispatchInParallel) {
+            if(this->parallelCallbackCount_ > 1) {
+                DispatchByPriority(args...);
+                return;
+            }
+        }
+
         for(auto& cb : this->callbacks_)
-            cb.callback(std::forward<Args>(args)...);
+            this->Invoke(cb, std::forward<Args>(args)...);
+    }
+
+protected:
+    // Listeners could race on mutable arguments (e.g. the retval flags of input events), so those always run serially
+    static constexpr bool CanDispatchInParallel = ((!std::is_reference_v<Args> || std::is_const_v<std::remove_reference_t<Args>>) && ...);
+
+    void DispatchByPriority(Args&... args) {
+        using Callback = typename EventBase<Func, Args...>::Callback;
+        std::vector<const Callback*> parallel;
+
+        auto& callbacks = this->callbacks_;
+        for(auto band = callbacks.begin(); band != callbacks.end();) {
+            auto bandEnd = std::find_if(band, callbacks.end(), [&](auto& cb) { return cb.priority != band->priority; });
+
+            parallel.clear();
+            for(auto it = band; it != bandEnd; ++it) {
+                if(it->dispatch == EventDispatch::Parallel)
+                    parallel.push_back(&*it);
+                else
+                    this->Invoke(*it, args...);
+            }
+
+            // Each priority band is joined before the next one starts
+            if(parallel.size() == 1)
+                this->Invoke(*parallel.front(), args...);
+            else if(!parallel.empty())
+                std::for_each(std::execution::par, parallel.begin(), parallel.end(), [&](const Callback* cb) { this->Invoke(*cb, args...); });
+
+            band = bandEnd;
+        }
+    }
+};
+
+template<typename T>
+class IntrusiveEvent;
+
+// Hook node embedded in each subscriber of an IntrusiveEvent; unlinks itself on destruction.
+template<typename T>
+class IntrusiveEventHook
+{
+public:
+    explicit IntrusiveEventHook(T* owner) : owner_(owner) { }
+    IntrusiveEventHook(const IntrusiveEventHook&) = delete;
+    IntrusiveEventHook(IntrusiveEventHook&&) = delete;
+    IntrusiveEventHook& operator=(const IntrusiveEventHook&) = delete;
+    IntrusiveEventHook& operator=(IntrusiveEventHook&&) = delete;
+    ~IntrusiveEventHook() {
+        if(event_)
+            event_->Remove(*this);
+    }
+
+    [[nodiscard]] bool linked() const { return event_ != nullptr; }
+
+private:
+    T* owner_;
+    IntrusiveEventHook* prev_ = nullptr;
+    IntrusiveEventHook* next_ = nullptr;
+    IntrusiveEvent<T>* event_ = nullptr;
+
+    friend class IntrusiveEvent<T>;
+};
+
+// Event for large numbers of homogeneous listeners: subscribing links the hook embedded in the listener (no allocation)
+// and dispatch is a plain walk over the list. T may be incomplete where the event is declared.
+template<typename T>
+class IntrusiveEvent
+{
+public:
+    using Hook = IntrusiveEventHook<T>;
+
+    IntrusiveEvent() = default;
+    IntrusiveEvent(const IntrusiveEvent&) = delete;
+    IntrusiveEvent(IntrusiveEvent&&) = delete;
+    IntrusiveEvent& operator=(const IntrusiveEvent&) = delete;
+    IntrusiveEvent& operator=(IntrusiveEvent&&) = delete;
+    ~IntrusiveEvent() {
+        while(head_)
+            Remove(*head_);
+    }
+
+    void Add(Hook& hook) {
+        if(hook.event_)
+            hook.event_->Remove(hook);
+
+        hook.event_ = this;
+        hook.prev_ = tail_;
+        hook.next_ = nullptr;
+        if(tail_)
+            tail_->next_ = &hook;
+        else
+            head_ = &hook;
+        tail_ = &hook;
+        size_++;
+    }
+
+    void Remove(Hook& hook) {
+        if(hook.event_ != this)
+            return;
+
+        // Keep an in-flight dispatch valid if a listener unsubscribes another (or itself)
+        if(dispatchNext_ == &hook)
+            dispatchNext_ = hook.next_;
+
+        if(hook.prev_)
+            hook.prev_->next_ = hook.next_;
+        else
+            head_ = hook.next_;
+        if(hook.next_)
+            hook.next_->prev_ = hook.prev_;
+        else
+            tail_ = hook.prev_;
+
+        hook.prev_ = hook.next_ = nullptr;
+        hook.event_ = nullptr;
+        size_--;
+    }
+
+    template<typename F>
+        requires std::invocable<F, T&>
+    void operator()(F&& f) {
+        for(Hook* h = head_; h; h = dispatchNext_) {
+            dispatchNext_ = h->next_;
+            f(*h->owner_);
+        }
+        dispatchNext_ = nullptr;
+    }
+
+    [[nodiscard]] size_t size() const { return size_; }
+    [[nodiscard]] bool empty() const { return size_ == 0; }
+
+protected:
+    Hook* head_ = nullptr;
+    Hook* tail_ = nullptr;
+    Hook* dispatchNext_ = nullptr;
+    size_t size_ = 0;
+};
+
+// Collects event invocations posted from any thread and runs them on the owning thread when drained.
+// Coalesced posts replace any pending invocation of the same event, so bursts collapse into a single call.
+class EventQueue
+{
+public:
+    EventQueue() = default;
+    EventQueue(const EventQueue&) = delete;
+    EventQueue(EventQueue&&) = delete;
+    EventQueue& operator=(const EventQueue&) = delete;
+    EventQueue& operator=(EventQueue&&) = delete;
+
+    template<typename E, typename... Args>
+    void Post(E& event, Args&&... args) {
+        Enqueue(nullptr, MakeInvocation(event, std::forward<Args>(args)...));
     }
+
+    // Only use for idempotent events: arguments of the most recent post win.
+    template<typename E, typename... Args>
+    void PostCoalesced(E& event, Args&&... args) {
+        Enqueue(&event, MakeInvocation(event, std::forward<Args>(args)...));
+    }
+
+    void Drain() {
+        {
+            std::lock_guard guard { mutex_ };
+            if(pending_.empty())
+                return;
+
+            std::swap(pending_, draining_);
+        }
+
+        for(auto& p : draining_)
+            p.invoke();
+
+        draining_.clear();
+    }
+
+protected:
+    struct Pending
+    {
+        const void* coalesceKey;
+        std::function<void()> invoke;
+    };
+
+    template<typename E, typename... Args>
+    static std::function<void()> MakeInvocation(E& event, Args&&... args) {
+        return [&event, ... args = std::decay_t<Args>(std::forward<Args>(args))]() mutable { event(args...); };
+    }
+
+    void Enqueue(const void* coalesceKey, std::function<void()>&& invoke) {
+        std::lock_guard guard { mutex_ };
+        if(coalesceKey) {
+            auto it = ranges::find_if(pending_, [coalesceKey](auto& p) { return p.coalesceKey == coalesceKey; });
+            if(it != pending_.end()) {
+                it->invoke = std::move(invoke);
+                return;
+            }
+        }
+
+        pending_.push_back({ coalesceKey, std::move(invoke) });
+    }
+
+    std::mutex mutex_;
+    std::vector<Pending> pending_;
+    std::vector<Pending> draining_;
 };
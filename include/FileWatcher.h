@@ -0,0 +1,56 @@
+#pragma once
+#include <filesystem>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "Common.h"
+#include "Singleton.h"
+
+// Reports changes other processes (or this one) make to individual files. The directories containing them are watched
+// from a background thread, with ReadDirectoryChangesW on Windows and inotify elsewhere. Callbacks run on that thread
+// with the watcher locked, so they should do little more than flag the change for later.
+class FileWatcher : public Singleton<FileWatcher>
+{
+public:
+    static constexpr bool ConcurrentInit = true;
+
+    using Callback = std::function<void(const std::filesystem::path& file)>;
+
+    FileWatcher();
+    ~FileWatcher();
+    FileWatcher(const FileWatcher&) = delete;
+    FileWatcher& operator=(const FileWatcher&) = delete;
+
+    [[nodiscard]] u32 Watch(const std::filesystem::path& file, Callback callback);
+    // No callback for the watch runs anymore once this returns
+    void Unwatch(u32 id);
+
+private:
+    struct WatchedFile
+    {
+        u32 id;
+        std::filesystem::path directory;
+        std::filesystem::path::string_type name;
+        Callback callback;
+    };
+
+    void Run(std::stop_token stop);
+    void Wake();
+    [[nodiscard]] std::vector<std::filesystem::path> directories();
+    void Notify(const std::filesystem::path& directory, std::filesystem::path::string_type name);
+
+    std::mutex mutex_;
+    std::vector<WatchedFile> files_;
+    u32 nextId_ = 1;
+    // Set when the watched directories need updating
+    bool directoriesChanged_ = false;
+
+#ifdef _WIN32
+    HANDLE wakeEvent_ = nullptr;
+#else
+    int wakeFd_ = -1;
+#endif
+    std::jthread thread_;
+};
@@ -12,6 +12,8 @@ class GFXSettings : public Singleton<GFXSettings>
     bool dpiScaling_ = false;
 
 public:
+    static constexpr bool ConcurrentInit = true;
+
     GFXSettings();
 
     void Reload();
@@ -81,6 +81,8 @@ inline std::wstring EventKeyToString(EventKey ek, Modifier activeModifiers) {
 class Input : public Singleton<Input>
 {
 public:
+    static constexpr bool ConcurrentInit = true;
+
     using MouseMoveEvent = Event<void(bool& retval), bool&>;
     using MouseButtonEvent = Event<void(EventKey ek, bool& retval), EventKey, bool&>;
     using InputLanguageChangeEvent = Event<void()>;
@@ -173,9 +175,9 @@ protected:
     std::list<DelayedInput> queuedInputs_;
     u32 blockKeybinds_ = 0;
 
-    MouseMoveEvent mouseMoveEvent_;
-    MouseButtonEvent mouseButtonEvent_;
-    InputLanguageChangeEvent inputLanguageChangeEvent_;
+    MouseMoveEvent mouseMoveEvent_ { "Input::mouseMoveEvent" };
+    MouseButtonEvent mouseButtonEvent_ { "Input::mouseButtonEvent" };
+    InputLanguageChangeEvent inputLanguageChangeEvent_ { "Input::inputLanguageChangeEvent" };
 
     std::unordered_map<KeyCombo, std::vector<ActivationKeybind*>> keybinds_;
     ActivationKeybind* activeKeybind_ = nullptr;
@@ -14,7 +14,7 @@ public:
     Keybind(std::string_view nickname, std::string_view displayName, std::string_view category, ScanCode key, Modifier mod, bool saveToConfig);
     Keybind(std::string_view nickname, std::string_view displayName, std::string_view category);
 
-    virtual ~Keybind();
+    virtual ~Keybind() = default;
 
     KeyCombo keyCombo() const { return { key_, mod_ }; }
     ScanCode key() const { return key_; }
@@ -44,7 +44,10 @@ public:
     void displayName(const std::string& n) { displayName_ = n; }
 
     [[nodiscard]] const std::string& nickname() const { return nickname_; }
-    void nickname(const std::string& n) { nickname_ = n; }
+    void nickname(const std::string& n) {
+        nickname_ = n;
+        configKey_ = {};
+    }
 
     [[nodiscard]] bool isSet() const { return key_ != ScanCode::None; }
 
@@ -68,10 +71,11 @@ protected:
     virtual void ApplyKeys();
 
     std::string displayName_, nickname_, category_;
+    ConfigKey configKey_;
     ScanCode key_;
     Modifier mod_;
     bool saveToConfig_ = true;
-    EventCallbackHandle languageChangeCallbackID_;
+    IntrusiveEventHook<Keybind> languageChangeHook_ { this };
 
     mutable std::array<char, 128> keysDisplayString_ {};
 };
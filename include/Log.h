@@ -1,11 +1,27 @@
 #pragma once
+#include <array>
+#include <atomic>
+#include <bit>
 #include <chrono>
-#include <deque>
+#include <concepts>
+#include <cstring>
+#include <format>
 #include <fstream>
 #include <mutex>
+#include <semaphore>
+#include <span>
 #include <string>
+#include <string_view>
+#include <thread>
+#include <tuple>
+#include <vector>
+
+#include <atomic_queue/atomic_queue.h>
 
 #include "Common.h"
+#include "LogFileFormat.h"
+#include "LogLineBuffer.h"
+#include "LogSearch.h"
 
 enum class Severity : uint8_t
 {
@@ -17,6 +33,211 @@ enum class Severity : uint8_t
     MaxVal = Debug | Info | Warn | Error
 };
 
+// Subsystem a message comes from, each with its own runtime severity filter
+enum class LogCategory : u8
+{
+    General,
+    Input,
+    Shader,
+    FS,
+    Config,
+    Mumble,
+    Graphics,
+
+    Count
+};
+
+namespace LogDetail
+{
+constexpr u32 CategoryShift(LogCategory cat) {
+    return u32(cat) * 4;
+}
+static_assert(EnumSize<LogCategory>() * 4 <= 64 && u8(Severity::MaxVal) <= 0xF);
+
+constexpr u64 AllCategories(u8 mask) {
+    u64 bits = 0;
+    for(u32 i = 0; i < EnumSize<LogCategory>(); i++)
+        bits |= u64(mask) << CategoryShift(LogCategory(i));
+    return bits;
+}
+
+template<typename T, typename CharT>
+concept StringArg = std::same_as<std::decay_t<T>, const CharT*> || std::same_as<std::decay_t<T>, CharT*> || requires(const T& t) {
+    { t.data() } -> std::convertible_to<const CharT*>;
+    { t.size() } -> std::convertible_to<size_t>;
+};
+
+// Log arguments are captured by value into the record payload: strings as a length followed by their characters,
+// everything else trivially copyable as raw bytes. Payloads are only byte-aligned, so decoding always copies out.
+template<typename T>
+struct ArgCodec
+{
+    using Decoded = T;
+
+    static size_t Size(const T&) { return sizeof(T); }
+    static void Encode(char*& out, const T& v) {
+        memcpy(out, &v, sizeof(T));
+        out += sizeof(T);
+    }
+    static T Decode(const char*& in) {
+        alignas(T) char storage[sizeof(T)];
+        memcpy(storage, in, sizeof(T));
+        in += sizeof(T);
+        return *std::launder(reinterpret_cast<T*>(storage));
+    }
+};
+
+template<typename CharT>
+struct StringArgCodec
+{
+    // Narrow strings can be viewed in place, wide ones would be misaligned
+    using Decoded = std::conditional_t<sizeof(CharT) == 1, std::basic_string_view<CharT>, std::basic_string<CharT>>;
+
+    template<typename T>
+    static std::basic_string_view<CharT> View(const T& v) {
+        if constexpr(std::is_array_v<T>)
+            return { v, std::char_traits<CharT>::length(v) };
+        else if constexpr(std::is_pointer_v<T>)
+            return v ? std::basic_string_view<CharT>(v) : std::basic_string_view<CharT>();
+        else
+            return { v.data(), v.size() };
+    }
+
+    template<typename T>
+    static size_t Size(const T& v) {
+        return sizeof(u32) + View(v).size() * sizeof(CharT);
+    }
+    template<typename T>
+    static void Encode(char*& out, const T& v) {
+        const auto sv = View(v);
+        const u32 len = u32(sv.size());
+        memcpy(out, &len, sizeof(u32));
+        memcpy(out + sizeof(u32), sv.data(), len * sizeof(CharT));
+        out += sizeof(u32) + len * sizeof(CharT);
+    }
+    static Decoded Decode(const char*& in) {
+        u32 len;
+        memcpy(&len, in, sizeof(u32));
+        in += sizeof(u32);
+
+        Decoded d;
+        if constexpr(sizeof(CharT) == 1)
+            d = Decoded(in, len);
+        else {
+            d.resize(len);
+            memcpy(d.data(), in, len * sizeof(CharT));
+        }
+        in += len * sizeof(CharT);
+        return d;
+    }
+};
+
+template<typename T>
+    requires StringArg<T, char>
+struct ArgCodec<T> : StringArgCodec<char>
+{ };
+
+template<typename T>
+    requires StringArg<T, wchar_t>
+struct ArgCodec<T> : StringArgCodec<wchar_t>
+{ };
+
+template<typename T>
+concept DeferrableArg = StringArg<T, char> || StringArg<T, wchar_t> || std::is_trivially_copyable_v<T>;
+
+using FormatFn = void (*)(std::string& out, const void* fmt, size_t fmtSize, const char* args);
+
+// Type of an argument as stored in binary log files, Unknown if the decoder could not format it
+template<typename T>
+constexpr LogFile::ArgType ArgTypeOf() {
+    using enum LogFile::ArgType;
+    if constexpr(StringArg<T, char>)
+        return String;
+    else if constexpr(StringArg<T, wchar_t>)
+        return WString;
+    else if constexpr(std::is_same_v<T, bool>)
+        return Bool;
+    else if constexpr(std::is_same_v<T, char>)
+        return Char;
+    else if constexpr(std::is_same_v<T, wchar_t>)
+        return WChar;
+    else if constexpr(std::is_integral_v<T> && sizeof(T) <= 8) {
+        constexpr LogFile::ArgType types[2][4] = { { UInt8, UInt16, UInt32, UInt64 }, { Int8, Int16, Int32, Int64 } };
+        return types[std::is_signed_v<T>][std::bit_width(sizeof(T)) - 1];
+    }
+    else if constexpr(std::is_same_v<T, float>)
+        return Float;
+    else if constexpr(std::is_floating_point_v<T> && sizeof(T) == sizeof(double))
+        return Double;
+    else if constexpr(std::is_pointer_v<T> && std::is_void_v<std::remove_pointer_t<T>>)
+        return Pointer;
+    else
+        return Unknown;
+}
+
+// Per argument type list description of a deferred record
+struct Formatter
+{
+    FormatFn format;
+    bool wide;
+    // Argument types for binary logs, only meaningful if binary is set
+    const LogFile::ArgType* argTypes;
+    u8 argCount;
+    bool binary;
+};
+} // namespace LogDetail
+
+// Per call site state of the LogDebug and LogInfo macros. Each site may log a burst of BurstSize messages, refilled at
+// one message per RefillInterval; anything beyond that is counted and periodically reported by the writer thread
+// instead. Warnings and errors are never limited.
+class LogCallSite
+{
+public:
+    static constexpr i64 BurstSize = 20;
+    static constexpr std::chrono::milliseconds RefillInterval { 100 };
+
+    constexpr LogCallSite(const char* file, u32 line, Severity sev, LogCategory cat) : file_(file), line_(line), sev_(sev), cat_(cat) { }
+    LogCallSite(const LogCallSite&) = delete;
+    LogCallSite& operator=(const LogCallSite&) = delete;
+
+    bool Acquire() {
+        using clock = std::chrono::steady_clock;
+        constexpr i64 interval = std::chrono::duration_cast<clock::duration>(RefillInterval).count();
+
+        // Generic cell rate algorithm: tat_ is when the bucket will be full again
+        const i64 now = clock::now().time_since_epoch().count();
+        i64 tat = tat_.load(std::memory_order_relaxed);
+        for(;;) {
+            const i64 next = std::max(tat, now) + interval;
+            if(next - now > BurstSize * interval) {
+                Suppress();
+                return false;
+            }
+            if(tat_.compare_exchange_weak(tat, next, std::memory_order_relaxed))
+                return true;
+        }
+    }
+
+private:
+    friend class Log;
+
+    void Suppress();
+
+    const char* file_;
+    u32 line_;
+    Severity sev_;
+    LogCategory cat_;
+    std::atomic<i64> tat_ = 0;
+    std::atomic<u32> suppressed_ = 0;
+    std::atomic<bool> registered_ = false;
+    LogCallSite* next_ = nullptr;
+
+    // Sites which have suppressed at least once, they are never unlinked
+    static inline std::atomic<LogCallSite*> suppressedSites_ = nullptr;
+};
+
+class LogSink;
+
 class Log : public Singleton<Log>
 {
 public:
@@ -28,72 +249,253 @@ public:
     bool isVisible() const { return isVisible_; }
     void isVisible(bool v) { isVisible_ = v; }
 
-    template<typename T, typename... Args>
-    void Print(Severity sev, const T& fmt, Args&&... args) {
-#ifndef _DEBUG
-        if(sev == Severity::Debug)
-            return;
-#endif
-        std::string l;
-        if constexpr(sizeof...(args) > 0)
-            l = ToString(std::vformat(fmt, MakeFormatArgs(fmt[0], args...)));
-        else
-            l = ToString(fmt);
+    // Blocks until every record queued so far has been written out, or the timeout expires
+    void Flush(std::chrono::milliseconds timeout = std::chrono::milliseconds(500));
+
+    // Sinks receive every message passing their filter from the writer thread, see LogSink. Sinks must not add or
+    // remove sinks from their Write.
+    LogSink& AddSink(std::unique_ptr<LogSink> sink);
+    // Delivers anything still pending to the sink before handing it back
+    std::unique_ptr<LogSink> RemoveSink(LogSink* sink);
+
+    // Writes the log file in the compact binary format of LogFileFormat.h instead of text from now on
+    void OpenBinaryLog(std::filesystem::path path);
+    // Additionally writes every line to a memory-mapped ring which survives the process crashing
+    void OpenCrashLog(const std::filesystem::path& path);
+
+    [[nodiscard]] u64 droppedRecords() const { return droppedRecords_.load(std::memory_order_relaxed); }
+
+    // Checked by the LogX macros before any argument is evaluated
+    [[nodiscard]] static bool enabled(Severity sev, LogCategory cat = LogCategory::General) {
+        return ((enabledSeverities_.load(std::memory_order_relaxed) >> LogDetail::CategoryShift(cat)) & u8(sev)) != 0;
+    }
+    [[nodiscard]] static u8 enabledSeverities(LogCategory cat) {
+        return u8((enabledSeverities_.load(std::memory_order_relaxed) >> LogDetail::CategoryShift(cat)) & u8(Severity::MaxVal));
+    }
+    static void enabledSeverities(LogCategory cat, u8 mask);
 
-        PrintInternal(sev, l);
+    void Print(Severity sev, std::string_view message) { Print(sev, LogCategory::General, message); }
+    void Print(Severity sev, std::wstring_view message) { Print(sev, LogCategory::General, message); }
+    void Print(Severity sev, LogCategory cat, std::string_view message);
+    void Print(Severity sev, LogCategory cat, std::wstring_view message);
+
+    // Arguments are captured into the record and only formatted by the writer thread. Format strings must therefore
+    // outlive the log, which holds for the literals std::format_string requires in practice.
+    template<typename... Args>
+    void Print(Severity sev, std::format_string<Args...> fmt, Args&&... args) {
+        PrintFormatted<char>(sev, LogCategory::General, fmt.get(), std::forward<Args>(args)...);
+    }
+    template<typename... Args>
+    void Print(Severity sev, std::wformat_string<Args...> fmt, Args&&... args) {
+        PrintFormatted<wchar_t>(sev, LogCategory::General, fmt.get(), std::forward<Args>(args)...);
+    }
+    template<typename... Args>
+    void Print(Severity sev, LogCategory cat, std::format_string<Args...> fmt, Args&&... args) {
+        PrintFormatted<char>(sev, cat, fmt.get(), std::forward<Args>(args)...);
+    }
+    template<typename... Args>
+    void Print(Severity sev, LogCategory cat, std::wformat_string<Args...> fmt, Args&&... args) {
+        PrintFormatted<wchar_t>(sev, cat, fmt.get(), std::forward<Args>(args)...);
     }
 
     void Draw();
 
+    static std::string ToString(const Timestamp& t);
+    static std::string_view ToString(const Timestamp& t, std::span<char> buffer);
+    static const char* ToString(Severity sev);
+    static const char* ToString(LogCategory cat);
+
 private:
-    void PrintInternal(Severity sev, const std::string& line);
+    class WindowSink;
 
-    std::string ToString(const std::string& s);
-    std::string ToString(const std::wstring& s);
-    std::string ToString(const Timestamp& t);
-    const char* ToString(Severity sev);
-    uint32_t ToColor(Severity sev);
+    // Record handed from the logging threads to the writer thread. Messages which fit the inline buffer are copied
+    // as is, longer ones spill into an allocation counted against OverflowBudget.
+    struct Record
+    {
+        static constexpr size_t InlineSize = 224;
 
-    template<typename... Args>
-    auto MakeFormatArgs(char, Args&&... args) {
-        return std::make_format_args(args...);
+        Timestamp::rep time;
+        Severity sev;
+        LogCategory cat;
+        u16 size;
+        // When set, text holds the encoded arguments for fmt rather than the message itself
+        const LogDetail::Formatter* formatter = nullptr;
+        const void* fmt = nullptr;
+        size_t fmtSize = 0;
+        std::array<char, InlineSize> text;
+        std::string overflow;
+
+        [[nodiscard]] std::string_view data() const {
+            return overflow.empty() ? std::string_view(text.data(), size) : std::string_view(overflow);
+        }
+    };
+    static constexpr u32 QueueCapacity = 2048;
+    static constexpr size_t OverflowBudget = 1024 * 1024;
+    static constexpr std::chrono::seconds SummaryInterval { 1 };
+
+    template<typename CharT, typename... Args>
+    void PrintFormatted(Severity sev, LogCategory cat, std::basic_string_view<CharT> fmt, Args&&... args) {
+        if constexpr((LogDetail::DeferrableArg<std::remove_cvref_t<Args>> && ...)) {
+            Record r;
+            r.formatter = &FormatterFor<CharT, std::remove_cvref_t<Args>...>;
+            r.fmt = fmt.data();
+            r.fmtSize = fmt.size();
+
+            const size_t size = (LogDetail::ArgCodec<std::remove_cvref_t<Args>>::Size(args) + ... + 0);
+            char* out;
+            if(size <= Record::InlineSize) {
+                r.size = u16(size);
+                out = r.text.data();
+            }
+            else if(ReserveOverflow(size)) {
+                r.size = 0;
+                r.overflow.resize(size);
+                out = r.overflow.data();
+            }
+            else {
+                // Too large to defer within budget, let the eager path truncate it
+                PrintInternal(sev, cat, FormatNow(fmt, args...));
+                return;
+            }
+            (LogDetail::ArgCodec<std::remove_cvref_t<Args>>::Encode(out, args), ...);
+
+            Push(sev, cat, std::move(r));
+        }
+        else
+            PrintInternal(sev, cat, FormatNow(fmt, args...));
     }
-    template<typename... Args>
-    auto MakeFormatArgs(wchar_t, Args&&... args) {
-        return std::make_wformat_args(args...);
+
+    template<typename CharT, typename... Args>
+    static std::string FormatNow(std::basic_string_view<CharT> fmt, Args&... args) {
+        if constexpr(std::is_same_v<CharT, char>)
+            return std::vformat(fmt, std::make_format_args(args...));
+        else {
+            std::string out;
+            AppendUtf8(out, std::vformat(fmt, std::make_wformat_args(args...)));
+            return out;
+        }
     }
 
+    template<typename CharT, typename... Ts>
+    static void FormatRecord(std::string& out, const void* fmt, size_t fmtSize, const char* args) {
+        // Braced initialization guarantees the arguments are decoded in order
+        std::tuple<typename LogDetail::ArgCodec<Ts>::Decoded...> decoded { LogDetail::ArgCodec<Ts>::Decode(args)... };
+        std::apply([&](auto&... a) {
+            std::basic_string_view<CharT> f(static_cast<const CharT*>(fmt), fmtSize);
+            if constexpr(std::is_same_v<CharT, char>)
+                std::vformat_to(std::back_inserter(out), f, std::make_format_args(a...));
+            else
+                AppendUtf8(out, std::vformat(f, std::make_wformat_args(a...)));
+        }, decoded);
+    }
+
+    template<typename... Ts>
+    static constexpr std::array<LogFile::ArgType, sizeof...(Ts)> ArgTypesFor { LogDetail::ArgTypeOf<Ts>()... };
+
+    template<typename CharT, typename... Ts>
+    static constexpr LogDetail::Formatter FormatterFor {
+        &FormatRecord<CharT, Ts...>, std::is_same_v<CharT, wchar_t>, ArgTypesFor<Ts...>.data(), u8(sizeof...(Ts)),
+        ((LogDetail::ArgTypeOf<Ts>() != LogFile::ArgType::Unknown) && ...)
+    };
+
+    static void AppendUtf8(std::string& out, std::wstring_view s);
+
+    void PrintInternal(Severity sev, LogCategory cat, std::string_view line);
+    bool ReserveOverflow(size_t size);
+    void Push(Severity sev, LogCategory cat, Record&& r);
+    void Wake();
+    void WriterLoop(std::stop_token stop);
+    void WriteBatch(bool final);
+    void WriteMessage(Severity sev, LogCategory cat, Timestamp::rep time, std::string_view message, const Record* source);
+    // source is the record message was formatted from, if any, so sinks can store it unformatted
+    void Emit(Severity sev, LogCategory cat, Timestamp::rep time, std::string_view message, const Record* source = nullptr);
+    void WriteSummaries();
+    void Deliver(LogSink& sink);
+    // Hands over batches which are due, or all of them; returns when the next one falls due
+    std::chrono::steady_clock::time_point DeliverSinks(bool all);
+
+    uint32_t ToColor(Severity sev);
+
     std::ofstream& logStream();
 
+#ifdef _DEBUG
+    static constexpr u8 DefaultSeverities = u8(Severity::MaxVal);
+#else
+    static constexpr u8 DefaultSeverities = u8(Severity::MaxVal) & ~u8(Severity::Debug);
+#endif
+    // One nibble of severity flags per category
+    static inline std::atomic<u64> enabledSeverities_ = LogDetail::AllCategories(DefaultSeverities);
+
     bool isVisible_ = false;
     bool autoscroll_ = true;
-    size_t maxLines_ = 500;
     uint8_t filter_ = uint8_t(Severity::MaxVal);
-    struct Line
-    {
-        Severity sev;
-        std::string time;
-        std::string message;
-    };
-    std::deque<Line> lines_;
+    static constexpr size_t MaxLines = 100'000;
+    static constexpr size_t MaxLineText = 8 * 1024 * 1024;
+    LogLineBuffer lines_ { MaxLines, MaxLineText };
+    LogSearch search_;
+    std::array<char, 256> searchText_ {};
+    bool searchRegex_ = false;
     std::mutex linesMutex_;
+
+    atomic_queue::AtomicQueue2<Record, QueueCapacity> records_;
+    std::atomic<bool> recordsPending_ = false;
+    std::binary_semaphore wakeup_ { 0 };
+    std::atomic<bool> flushRequested_ = false;
+    std::atomic<u64> recordsQueued_ = 0;
+    std::atomic<u64> recordsWritten_ = 0;
+    std::atomic<u64> droppedRecords_ = 0;
+    std::atomic<u64> truncatedRecords_ = 0;
+    std::atomic<size_t> overflowBytes_ = 0;
+    u64 reportedDroppedRecords_ = 0;
+    u64 reportedTruncatedRecords_ = 0;
+    std::string formatted_;
+    std::vector<std::unique_ptr<LogSink>> sinks_;
+    // Either the text or the binary log file, replaced by OpenBinaryLog
+    LogSink* fileSink_ = nullptr;
+    std::mutex sinksMutex_;
+    // Consecutive identical messages are collapsed into a repeat count
+    std::string lastMessage_;
+    Severity lastSeverity_ = Severity::Info;
+    LogCategory lastCategory_ = LogCategory::General;
+    Timestamp::rep lastTime_ = 0;
+    u64 repeats_ = 0;
+    std::chrono::steady_clock::time_point nextSummary_;
+    std::chrono::steady_clock::time_point nextDelivery_ = std::chrono::steady_clock::time_point::max();
+    std::jthread writer_;
 };
 
-#define DEFINE_LOG(sev, name)                                  \
-    template<typename T, typename... Args>                     \
-    void name(const T& fmt, Args&&... args) {                  \
-        Log::i().Print(sev, fmt, args...); \
-    }
+#define LOG_AT(sev, cat, ...)                                                          \
+    do {                                                                               \
+        if(Log::enabled(sev, cat)) {                                                   \
+            static constinit LogCallSite logCallSite_ { __FILE__, __LINE__, sev, cat }; \
+            if(logCallSite_.Acquire())                                                 \
+                Log::i().Print(sev, cat, __VA_ARGS__);                                 \
+        }                                                                              \
+    } while(false)
+
+// Like LOG_AT without the rate limit, for warnings and errors and for reports logging once per item of a loop
+#define LOG_UNLIMITED_AT(sev, cat, ...)            \
+    do {                                           \
+        if(Log::enabled(sev, cat))                 \
+            Log::i().Print(sev, cat, __VA_ARGS__); \
+    } while(false)
 
 #ifdef _DEBUG
-DEFINE_LOG(Severity::Debug, LogDebug);
+#define LogDebug(...) LOG_AT(Severity::Debug, LogCategory::General, __VA_ARGS__)
 #else
 #define LogDebug(...)
 #endif
 
-DEFINE_LOG(Severity::Info, LogInfo);
-DEFINE_LOG(Severity::Warn, LogWarn);
-DEFINE_LOG(Severity::Error, LogError);
+#define LogInfo(...) LOG_AT(Severity::Info, LogCategory::General, __VA_ARGS__)
+#define LogInfoUnlimited(...) LOG_UNLIMITED_AT(Severity::Info, LogCategory::General, __VA_ARGS__)
+#define LogWarn(...) LOG_UNLIMITED_AT(Severity::Warn, LogCategory::General, __VA_ARGS__)
+#define LogError(...) LOG_UNLIMITED_AT(Severity::Error, LogCategory::General, __VA_ARGS__)
+
+// Categorized debug output is kept in release builds, so it can be enabled per category at runtime
+#define LogDebugCat(cat, ...) LOG_AT(Severity::Debug, LogCategory::cat, __VA_ARGS__)
+#define LogInfoCat(cat, ...) LOG_AT(Severity::Info, LogCategory::cat, __VA_ARGS__)
+#define LogWarnCat(cat, ...) LOG_UNLIMITED_AT(Severity::Warn, LogCategory::cat, __VA_ARGS__)
+#define LogErrorCat(cat, ...) LOG_UNLIMITED_AT(Severity::Error, LogCategory::cat, __VA_ARGS__)
 
 struct LogPtr_
 {
@@ -0,0 +1,134 @@
+#pragma once
+#include <cstdint>
+
+// Layout of binary log files, shared with the offline decoder in tools/logdecode so it must stay free of any
+// Windows or addon dependencies. All values are little-endian and structures are packed.
+//
+// A file starts with a FileHeader and is followed by records, each starting with their RecordType:
+// - FormatDef: FormatDefHeader, ArgType[argCount], UTF-8 format string of formatSize bytes.
+//   Defines a format string ID, valid until the end of the file. Wide format strings are stored converted to UTF-8.
+// - Message: MessageHeader, payloadSize bytes of arguments encoded in the order of the definition's ArgTypes.
+// - Text: TextHeader, UTF-8 message of size bytes, used for messages whose arguments cannot be stored raw.
+namespace LogFile
+{
+inline constexpr char Magic[8] = { 'G', 'W', '2', 'L', 'O', 'G', 'B', '\0' };
+inline constexpr uint32_t Version = 1;
+
+enum class RecordType : uint8_t
+{
+    FormatDef = 1,
+    Message = 2,
+    Text = 3,
+};
+
+// Scalars are stored raw at their natural size; String and WString as a uint32_t length in code units followed by
+// the code units (WString code units are FileHeader::wcharSize bytes, UTF-16 on Windows).
+enum class ArgType : uint8_t
+{
+    Unknown = 0,
+    Bool,
+    Char,
+    WChar,
+    Int8,
+    UInt8,
+    Int16,
+    UInt16,
+    Int32,
+    UInt32,
+    Int64,
+    UInt64,
+    Float,
+    Double,
+    Pointer,
+    String,
+    WString,
+};
+
+#pragma pack(push, 1)
+struct FileHeader
+{
+    char magic[8];
+    uint32_t version;
+    uint8_t pointerSize;
+    uint8_t wcharSize;
+    uint16_t reserved;
+    // Timestamps are ticks of this resolution since the Unix epoch, in UTC
+    int64_t ticksPerSecond;
+};
+
+struct FormatDefHeader
+{
+    RecordType type;
+    uint32_t id;
+    uint8_t argCount;
+    uint32_t formatSize;
+};
+
+struct MessageHeader
+{
+    RecordType type;
+    int64_t time;
+    uint8_t severity;
+    uint32_t formatId;
+    uint32_t payloadSize;
+};
+
+struct TextHeader
+{
+    RecordType type;
+    int64_t time;
+    uint8_t severity;
+    uint32_t size;
+};
+#pragma pack(pop)
+} // namespace LogFile
+
+// Layout of the crash log ring: a fixed-size memory-mapped file which the log writer stores text records into.
+// Records are 8-byte aligned and never wrap, the end of the ring is filled with a padding record instead. After a crash
+// the ring is read back by tools/logring, which orders the surviving records by sequence number.
+namespace LogRing
+{
+inline constexpr char Magic[8] = { 'G', 'W', '2', 'L', 'O', 'G', 'R', '\0' };
+inline constexpr uint32_t Version = 1;
+inline constexpr uint32_t RecordMagic = 0x52474F4C; // "LOGR"
+inline constexpr uint64_t Alignment = 8;
+
+enum RecordFlags : uint8_t
+{
+    Padding = 1,
+};
+
+struct Header
+{
+    char magic[8];
+    uint32_t version;
+    uint32_t headerSize;
+    // Size of the record area following the header
+    uint64_t capacity;
+    // Absolute (unwrapped) offset and sequence number of the next record, advisory only
+    uint64_t writeOffset;
+    uint64_t nextSequence;
+    int64_t ticksPerSecond;
+};
+
+// Followed by size bytes of UTF-8 text, then padding up to Alignment. The magic is stored last so a record torn
+// by the writer dying mid-copy is not mistaken for a complete one.
+struct RecordHeader
+{
+    uint32_t magic;
+    uint32_t size;
+    uint64_t sequence;
+    int64_t time;
+    uint8_t severity;
+    uint8_t flags;
+    uint16_t reserved;
+    uint32_t reserved2;
+};
+
+static_assert(sizeof(Header) % Alignment == 0);
+static_assert(sizeof(RecordHeader) % Alignment == 0);
+
+constexpr uint64_t RecordSize(uint64_t textSize) {
+    return (sizeof(RecordHeader) + textSize + Alignment - 1) & ~(Alignment - 1);
+}
+} // namespace LogRing
@@ -0,0 +1,74 @@
+#pragma once
+#include <array>
+#include <memory>
+#include <string_view>
+
+#include "Common.h"
+
+enum class Severity : uint8_t;
+
+// Fixed-capacity ring of log lines. Line text lives in a single circular slab, so pushing a line never allocates;
+// the oldest lines are evicted once either the line ring or the slab runs out of room.
+// Filtered views by severity mask are indexed incrementally, each mask's index being built the first time it is used.
+class LogLineBuffer
+{
+public:
+    struct Line
+    {
+        i64 time;
+        u64 textPos;
+        u32 textSize;
+        Severity sev;
+    };
+
+    LogLineBuffer(size_t maxLines, size_t textCapacity);
+
+    void Push(i64 time, Severity sev, std::string_view text);
+    void Clear();
+
+    [[nodiscard]] size_t size() const { return size_t(head_ - tail_); }
+    [[nodiscard]] bool empty() const { return head_ == tail_; }
+    [[nodiscard]] size_t capacity() const { return maxLines_; }
+
+    // Sequence numbers increase monotonically and are never reused, lines in [firstSequence(), endSequence()) are live
+    [[nodiscard]] u64 firstSequence() const { return tail_; }
+    [[nodiscard]] u64 endSequence() const { return head_; }
+
+    // Index 0 is the oldest line still held
+    [[nodiscard]] const Line& operator[](size_t i) const { return bySequence(tail_ + i); }
+    [[nodiscard]] const Line& bySequence(u64 seq) const { return lines_[seq % maxLines_]; }
+    [[nodiscard]] std::string_view text(const Line& l) const { return { text_.get() + l.textPos % textCapacity_, l.textSize }; }
+
+    // Number of lines whose severity is in mask, and the i-th of them (oldest first)
+    [[nodiscard]] size_t filteredSize(u8 mask);
+    [[nodiscard]] const Line& filtered(u8 mask, size_t i);
+
+private:
+    static constexpr u8 AllSeverities = 0xF;
+
+    // Ring of the sequence numbers matching a mask. Sequence numbers are stored truncated to 32 bits and restored
+    // relative to the oldest live line, which is always less than 2^32 lines back.
+    struct MaskIndex
+    {
+        std::unique_ptr<u32[]> sequences;
+        u64 head = 0;
+        u64 tail = 0;
+
+        [[nodiscard]] size_t size() const { return size_t(head - tail); }
+    };
+
+    void PopFront();
+    MaskIndex& index(u8 mask);
+
+    std::array<MaskIndex, AllSeverities> indices_;
+
+    size_t maxLines_;
+    size_t textCapacity_;
+    std::unique_ptr<Line[]> lines_;
+    std::unique_ptr<char[]> text_;
+
+    u64 head_ = 0;
+    u64 tail_ = 0;
+    // Absolute write position in the slab, the slab holds [textHead_ - textCapacity_, textHead_)
+    u64 textHead_ = 0;
+};
@@ -0,0 +1,60 @@
+#pragma once
+#include <deque>
+#include <optional>
+#include <regex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "Common.h"
+
+class LogLineBuffer;
+
+// Live search over a LogLineBuffer. Lines are indexed by case-folded trigram in blocks of consecutive lines, so a new
+// substring query only verifies the blocks which contain all of its trigrams. Regex queries scan once when they change.
+// Both then only look at lines added since the previous update.
+class LogSearch
+{
+public:
+    enum class Mode
+    {
+        Substring,
+        Regex
+    };
+
+    // Cheap when nothing changed, call every frame with the current search box contents
+    void Query(std::string_view query, Mode mode, u8 severityMask);
+    // Catches up with lines pushed or evicted since the last call
+    void Update(const LogLineBuffer& lines);
+
+    [[nodiscard]] bool active() const { return !query_.empty(); }
+    // False if the current regex failed to compile, in which case nothing matches
+    [[nodiscard]] bool valid() const { return mode_ != Mode::Regex || regex_.has_value(); }
+    [[nodiscard]] size_t size() const { return matches_.size(); }
+    // Sequence number of the i-th match, oldest first
+    [[nodiscard]] u64 operator[](size_t i) const { return matches_[i]; }
+
+private:
+    static constexpr u64 BlockLines = 32;
+    static constexpr u64 PruneInterval = 1024;
+
+    void Index(const LogLineBuffer& lines, u64 begin, u64 end);
+    void Prune(u64 firstBlock);
+    void Rescan(const LogLineBuffer& lines);
+    [[nodiscard]] bool Matches(const LogLineBuffer& lines, u64 seq) const;
+
+    std::string query_;
+    Mode mode_ = Mode::Substring;
+    u8 severityMask_ = 0;
+    std::optional<std::regex> regex_;
+    bool dirty_ = false;
+
+    std::deque<u64> matches_;
+    u64 scannedEnd_ = 0;
+
+    // Trigram to ascending list of block numbers (sequence / BlockLines) containing it
+    std::unordered_map<u32, std::vector<u64>> postings_;
+    u64 indexedEnd_ = 0;
+    u64 prunedBlock_ = 0;
+    std::vector<u32> lineTrigrams_;
+};
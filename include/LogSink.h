@@ -0,0 +1,183 @@
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <fstream>
+#include <functional>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "Common.h"
+#include <gw2load/api.h>
+
+enum class Severity : uint8_t;
+enum class LogCategory : u8;
+namespace LogDetail
+{
+struct Formatter;
+}
+class BinaryLogFile;
+class MappedLogRing;
+
+struct LogEntry
+{
+    i64 time;
+    Severity sev;
+    LogCategory cat;
+    std::string_view message;
+
+    // Set when message was formatted from deferred arguments, for sinks which store them unformatted
+    const LogDetail::Formatter* formatter = nullptr;
+    const void* fmt = nullptr;
+    size_t fmtSize = 0;
+    std::string_view payload;
+};
+
+// Entries accumulated for a sink, owning copies of their text so they can be held across writer batches
+class LogBatch
+{
+public:
+    void Add(const LogEntry& e);
+    void Clear();
+
+    [[nodiscard]] size_t size() const { return entries_.size(); }
+    [[nodiscard]] bool empty() const { return entries_.empty(); }
+    [[nodiscard]] LogEntry operator[](size_t i) const;
+
+    template<typename F>
+    void ForEach(F&& f) const {
+        for(size_t i = 0; i < entries_.size(); i++)
+            f((*this)[i]);
+    }
+
+private:
+    struct Stored
+    {
+        i64 time;
+        Severity sev;
+        LogCategory cat;
+        u32 messageOffset;
+        u32 messageSize;
+        const LogDetail::Formatter* formatter;
+        const void* fmt;
+        size_t fmtSize;
+        u32 payloadOffset;
+        u32 payloadSize;
+    };
+
+    std::vector<Stored> entries_;
+    std::string data_;
+};
+
+// Destination for log entries. Sinks are driven by the log writer thread: entries passing the sink's filter are
+// accumulated and handed over in batches, once maxEntries are pending or the oldest has waited maxDelay. A zero delay
+// delivers at the end of every round of the writer.
+class LogSink
+{
+public:
+    struct BatchPolicy
+    {
+        size_t maxEntries = 256;
+        std::chrono::milliseconds maxDelay { 0 };
+    };
+
+    static constexpr u32 AllCategories = (1u << u32(LogCategory::Count)) - 1;
+
+    explicit LogSink(u8 severities) : LogSink(severities, BatchPolicy {}) { }
+    LogSink(u8 severities, BatchPolicy policy) : severities_(severities), policy_(policy) { }
+    virtual ~LogSink() = default;
+
+    [[nodiscard]] u8 severities() const { return severities_.load(std::memory_order_relaxed); }
+    void severities(u8 mask) { severities_.store(mask, std::memory_order_relaxed); }
+    // One bit per LogCategory
+    [[nodiscard]] u32 categories() const { return categories_.load(std::memory_order_relaxed); }
+    void categories(u32 mask) { categories_.store(mask, std::memory_order_relaxed); }
+    [[nodiscard]] const BatchPolicy& policy() const { return policy_; }
+
+    [[nodiscard]] virtual bool Accepts(const LogEntry& e) const {
+        return (u8(e.sev) & severities()) != 0 && (categories() & (1u << u32(e.cat))) != 0;
+    }
+    virtual void Write(const LogBatch& batch) = 0;
+
+protected:
+    // "[time|SEV] message\n"
+    static void AppendLine(std::string& out, const LogEntry& e);
+
+private:
+    std::atomic<u8> severities_;
+    std::atomic<u32> categories_ = AllCategories;
+    BatchPolicy policy_;
+
+    // Owned by the writer thread
+    LogBatch pending_;
+    std::chrono::steady_clock::time_point deadline_;
+
+    friend class Log;
+};
+
+class TextFileLogSink : public LogSink
+{
+public:
+    explicit TextFileLogSink(std::ofstream& stream, u8 severities);
+    void Write(const LogBatch& batch) override;
+
+private:
+    std::ofstream& stream_;
+    std::string text_;
+};
+
+class DebuggerLogSink : public LogSink
+{
+public:
+    explicit DebuggerLogSink(u8 severities);
+    void Write(const LogBatch& batch) override;
+
+private:
+    std::string text_;
+};
+
+class BinaryFileLogSink : public LogSink
+{
+public:
+    BinaryFileLogSink(std::unique_ptr<BinaryLogFile> file, u8 severities);
+    ~BinaryFileLogSink() override;
+    void Write(const LogBatch& batch) override;
+
+private:
+    std::unique_ptr<BinaryLogFile> file_;
+};
+
+class CrashRingLogSink : public LogSink
+{
+public:
+    CrashRingLogSink(std::unique_ptr<MappedLogRing> ring, u8 severities);
+    ~CrashRingLogSink() override;
+    void Write(const LogBatch& batch) override;
+
+private:
+    std::unique_ptr<MappedLogRing> ring_;
+};
+
+// Forwards to the loader's shared log, which prefixes the addon name itself
+class LoaderLogSink : public LogSink
+{
+public:
+    LoaderLogSink(HMODULE gw2loadHandle, u8 severities);
+    void Write(const LogBatch& batch) override;
+
+private:
+    GW2Load_LogFunc log_ = nullptr;
+};
+
+class CallbackLogSink : public LogSink
+{
+public:
+    using Callback = std::function<void(const LogBatch&)>;
+
+    CallbackLogSink(Callback callback, u8 severities, BatchPolicy policy = {});
+    void Write(const LogBatch& batch) override;
+
+private:
+    Callback callback_;
+};
@@ -22,9 +22,15 @@ extern "C"
         GW2Load_API          api(gw2loadHandle);
         DXGI_SWAP_CHAIN_DESC desc;
         swapChain->GetDesc(&desc);
+        // The text sink writes to g_logStream from the log thread, which the first Log::i() starts
+#ifdef GW2COMMON_BINARY_LOG
+        Log::i().OpenBinaryLog(std::format("addons/_logs/{}.gw2log", ToLower(AddonName)));
+#else
         auto logName = std::format("addons/_logs/{}.log", ToLower(AddonName));
         g_logStream = std::ofstream(logName.c_str());
-        BaseCore::Init(g_hModule, api);
+#endif
+        Log::i().OpenCrashLog(std::format("addons/_logs/{}.ring", ToLower(AddonName)));
+        BaseCore::Init(g_hModule, gw2loadHandle, api);
         GetBaseCore().PostCreateSwapChain(desc.OutputWindow, device, swapChain);
 
         api.RegisterCallback(GW2Load_HookedFunction::Present, 0, GW2Load_CallbackPoint::BeforeCall, [](IDXGISwapChain* swapChain) { GetBaseCore().Draw(); });
@@ -0,0 +1,38 @@
+#pragma once
+#include <filesystem>
+
+#include "Common.h"
+#include "LogFileFormat.h"
+
+enum class Severity : uint8_t;
+
+// Crash log ring (see LogRing in LogFileFormat.h) backed by a memory-mapped file. Records are written with plain stores
+// into the mapped view and never flushed explicitly: the pages belong to the OS, so they reach the disk even if the
+// process dies. The ring from the previous session is kept alongside with a .prev extension.
+// Only used from the log writer thread.
+class MappedLogRing
+{
+public:
+    static constexpr u64 DefaultCapacity = 4 * 1024 * 1024;
+
+    MappedLogRing(const std::filesystem::path& path, u64 capacity = DefaultCapacity);
+    ~MappedLogRing();
+    MappedLogRing(const MappedLogRing&) = delete;
+    MappedLogRing& operator=(const MappedLogRing&) = delete;
+
+    [[nodiscard]] bool isOpen() const { return header_ != nullptr; }
+
+    void Write(i64 time, Severity sev, std::string_view text);
+
+private:
+    void WriteRecord(u64 offset, i64 time, u8 sev, u8 flags, std::string_view text, u32 size);
+
+    HANDLE file_ = INVALID_HANDLE_VALUE;
+    HANDLE mapping_ = nullptr;
+    LogRing::Header* header_ = nullptr;
+    char* records_ = nullptr;
+
+    u64 capacity_;
+    u64 writeOffset_ = 0;
+    u64 sequence_ = 0;
+};
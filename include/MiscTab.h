@@ -12,4 +12,7 @@ public:
 
     const char* GetTabName() const override { return "Misc"; }
     void DrawMenu(Keybind**) override;
+
+protected:
+    void DrawEventProfiling();
 };
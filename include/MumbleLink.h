@@ -24,6 +24,8 @@ enum class ConditionalState : u32
 class MumbleLink : public Singleton<MumbleLink>
 {
 public:
+    static constexpr bool ConcurrentInit = true;
+
     enum class Profession : u8
     {
         None = 0,
@@ -50,7 +50,7 @@ protected:
     T data;
 
 public:
-    ~ConstantBuffer() { LogDebug("Constant buffer of type {} destroyed", typeid(T).name()); }
+    ~ConstantBuffer() { LogDebugCat(Shader, "Constant buffer of type {} destroyed", typeid(T).name()); }
 
     ConstantBuffer() = default;
 
@@ -1,9 +1,28 @@
 #pragma once
+#include <array>
+#include <atomic>
+#include <chrono>
 #include <concepts>
+#include <exception>
 #include <functional>
 #include <memory>
-#include <stack>
+#include <mutex>
+#include <span>
 #include <stdexcept>
+#include <typeindex>
+#include <vector>
+
+// Declared by a singleton as `using Dependencies = SingletonDependencies<A, B>;` when its constructor uses A and B
+template<typename... Ts>
+struct SingletonDependencies
+{ };
+
+// Declared by a singleton as `static constexpr bool ConcurrentInit = true;` when its constructor only touches state of
+// its own or state guarded by a lock, so SingletonInitializer may run it alongside others
+template<typename T>
+concept ConcurrentInitSingleton = requires {
+    requires T::ConcurrentInit;
+};
 
 class BaseSingleton
 {
@@ -11,26 +30,51 @@ public:
     virtual ~BaseSingleton() = default;
 
 protected:
-    static BaseSingleton* Store(std::unique_ptr<BaseSingleton>&& ptr);
+    // Current instance of a dependency, if any
+    using InstanceFn = BaseSingleton* (*)();
+
+    static BaseSingleton* Store(std::unique_ptr<BaseSingleton>&& ptr, const char* name, std::span<const InstanceFn> dependencies);
     static void Clear(BaseSingleton* ptr);
+
+private:
+    friend class SingletonManager;
+
+    // Intrusive links of SingletonManager's list, in construction order
+    BaseSingleton* prev_ = nullptr;
+    BaseSingleton* next_ = nullptr;
+    bool linked_ = false;
+    const char* name_ = nullptr;
+    std::span<const InstanceFn> dependencies_;
 };
 
 class SingletonManager
 {
 public:
+    using DestroyedCallback = std::function<void(const char* name, std::chrono::microseconds duration)>;
+
     SingletonManager() = default;
-    void Shutdown() {
-        while(!singletons_.empty())
-            singletons_.pop();
-    }
+    ~SingletonManager() { Shutdown(); }
+
+    // Destroys every singleton, dependents before their dependencies and otherwise newest first. onDestroyed is called
+    // after each one, outside of any lock.
+    void Shutdown(const DestroyedCallback& onDestroyed = {});
 
 private:
-    std::stack<std::unique_ptr<BaseSingleton>> singletons_;
+    void Link(BaseSingleton* s);
+    void Unlink(BaseSingleton* s);
+    bool HasDependents(const BaseSingleton* s) const;
+
+    BaseSingleton* head_ = nullptr;
+    BaseSingleton* tail_ = nullptr;
+    // Singletons may be constructed concurrently by SingletonInitializer
+    std::mutex mutex_;
 
     friend class BaseSingleton;
 };
 extern SingletonManager g_singletonManagerInstance;
 
+// Safe to access from any thread. Once constructed, i() is a single acquire load and branch; construction itself
+// happens once, under a per-type lock.
 template<typename T>
 class Singleton : public BaseSingleton
 {
@@ -38,49 +82,153 @@ public:
     template<typename T2 = T>
         requires std::derived_from<T2, T>
     static T2& i() {
-        if(!init_) {
-            if constexpr(std::is_default_constructible_v<T2>) {
-                init_ = true;
-                i_ = (T*)Store(std::make_unique<T2>());
-            }
-            else
-                throw std::logic_error("Singleton is not default-constructible but was not explicitly initialized before access.");
-        }
+        if(T* ptr = i_.load(std::memory_order_acquire)) [[likely]]
+            return *static_cast<T2*>(ptr);
 
-        return *(T2*)i_;
+        return Construct<T2>();
     }
 
     template<typename T2 = T, typename... Args>
         requires std::derived_from<T2, T>
     static T2& init(Args&&... args) {
-        init_ = true;
-        i_ = (T*)Store(std::make_unique<T2>(std::forward<Args>(args)...));
-        return *(T2*)i_;
+        std::lock_guard guard { initMutex_ };
+        auto* ptr = static_cast<T*>(Store(std::make_unique<T2>(std::forward<Args>(args)...), typeid(T2).name(), DependenciesOf<T2>()));
+        i_.store(ptr, std::memory_order_release);
+        return *static_cast<T2*>(ptr);
     }
 
     template<typename T2>
         requires std::derived_from<T2, T>
     static void f(std::function<void(T2&)> action) {
-        if(i_)
-            action(static_cast<T2&>(i_));
+        if(T* ptr = i_.load(std::memory_order_acquire))
+            action(static_cast<T2&>(*ptr));
     }
 
     static void f(std::function<void(T&)> action) {
-        if(i_)
-            action(*i_);
+        if(T* ptr = i_.load(std::memory_order_acquire))
+            action(*ptr);
     }
 
     static void reset() {
-        if(init_)
-            Clear(i_);
+        if(T* ptr = i_.load(std::memory_order_acquire))
+            Clear(ptr);
+    }
+
+    ~Singleton() override { i_.store(nullptr, std::memory_order_release); }
+
+private:
+    template<typename>
+    friend class Singleton;
+
+    template<typename T2>
+    static T2& Construct() {
+        if constexpr(std::is_default_constructible_v<T2>) {
+            std::lock_guard guard { initMutex_ };
+            // Another thread may have won the race for the lock
+            if(T* ptr = i_.load(std::memory_order_relaxed))
+                return *static_cast<T2*>(ptr);
+
+            auto* ptr = static_cast<T*>(Store(std::make_unique<T2>(), typeid(T2).name(), DependenciesOf<T2>()));
+            i_.store(ptr, std::memory_order_release);
+            return *static_cast<T2*>(ptr);
+        }
+        else
+            throw std::logic_error("Singleton is not default-constructible but was not explicitly initialized before access.");
+    }
+
+    static BaseSingleton* instance() { return i_.load(std::memory_order_acquire); }
+
+    template<typename... Ts>
+    static constexpr std::array<InstanceFn, sizeof...(Ts)> InstanceFns(SingletonDependencies<Ts...>) {
+        return { &Singleton<Ts>::instance... };
+    }
+
+    template<typename T2>
+    static std::span<const InstanceFn> DependenciesOf() {
+        if constexpr(requires { typename T2::Dependencies; }) {
+            static constexpr auto fns = InstanceFns(typename T2::Dependencies {});
+            return fns;
+        }
+        else
+            return {};
+    }
+
+    constinit inline static std::atomic<T*> i_ = nullptr;
+    constinit inline static std::mutex initMutex_;
+};
+
+// Constructs a set of singletons up front rather than on first use. Singletons are grouped into waves by their
+// declared Dependencies, which are added automatically, and constructors may only use singletons which already exist
+// or are declared as dependencies. Within a wave, the singletons declaring ConcurrentInit are constructed in parallel
+// first, then every other one by itself in the order added. Constructors which register configuration options,
+// keybinds or event handlers touch shared tables without a lock and must not declare it.
+class SingletonInitializer
+{
+public:
+    struct Result
+    {
+        const char* name;
+        size_t wave;
+        std::chrono::microseconds duration;
+        // Set if the constructor threw, or was skipped because a dependency failed
+        std::exception_ptr error;
+    };
+
+    template<typename T>
+    SingletonInitializer& Add() {
+        AddNode<T>({});
+        return *this;
     }
 
-    ~Singleton() override {
-        i_ = nullptr;
-        init_ = false;
+    // For singletons which need constructor arguments, construct should call T::init
+    template<typename T>
+    SingletonInitializer& Add(std::function<void()> construct) {
+        AddNode<T>(std::move(construct));
+        return *this;
     }
 
+    // Throws std::logic_error if the dependencies form a cycle, other failures are reported in the results
+    std::vector<Result> Run();
+
 private:
-    inline static bool init_ = false;
-    inline static T* i_ = nullptr;
+    struct Node
+    {
+        std::type_index type;
+        const char* name;
+        std::function<void()> construct;
+        std::vector<size_t> dependencies;
+        bool concurrent;
+    };
+
+    template<typename T>
+    size_t AddNode(std::function<void()> construct) {
+        for(size_t i = 0; i < nodes_.size(); i++) {
+            if(nodes_[i].type == typeid(T)) {
+                if(construct)
+                    nodes_[i].construct = std::move(construct);
+                return i;
+            }
+        }
+
+        if(!construct)
+            construct = [] { T::i(); };
+
+        const size_t index = nodes_.size();
+        nodes_.push_back({ typeid(T), typeid(T).name(), std::move(construct), {}, ConcurrentInitSingleton<T> });
+        if constexpr(requires { typename T::Dependencies; }) {
+            auto dependencies = AddDependencies(typename T::Dependencies {});
+            nodes_[index].dependencies = std::move(dependencies);
+        }
+        return index;
+    }
+
+    template<typename... Ts>
+    std::vector<size_t> AddDependencies(SingletonDependencies<Ts...>) {
+        // Braced initialization guarantees left to right evaluation
+        return { AddNode<Ts>({})... };
+    }
+
+    size_t Wave(size_t node, std::vector<size_t>& waves, std::vector<bool>& visiting) const;
+
+    std::vector<Node> nodes_;
 };
@@ -7,6 +7,8 @@
 class UpdateCheck : public Singleton<UpdateCheck>
 {
 public:
+    using Dependencies = SingletonDependencies<INIConfigurationFile>;
+
     UpdateCheck(const std::wstring& repoId);
 
     void CheckForUpdates();
@@ -57,6 +57,15 @@ std::span<byte> LoadResource(HMODULE dll, UINT resId);
 
 // ReSharper restore CppInconsistentNaming
 
+// 64-bit FNV-1a, for telling apart file contents rather than anything security related
+constexpr u64 Fnv1a(std::string_view data, u64 hash = 0xcbf29ce484222325ull) {
+    for(const char c : data) {
+        hash ^= u8(c);
+        hash *= 0x100000001b3ull;
+    }
+    return hash;
+}
+
 inline f32 Lerp(f32 a, f32 b, f32 s) {
     if(s < 0)
         return a;
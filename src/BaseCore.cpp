@@ -8,9 +8,14 @@
 #include <imgui/imgui.h>
 #include <shellapi.h>
 
+#include "ConfigurationFile.h"
 #include "GFXSettings.h"
 #include "Graphics.h"
 #include "ImGuiPopup.h"
+#include "Input.h"
+#include "Keybind.h"
+#include "LogSink.h"
+#include "MumbleLink.h"
 #include "ShaderManager.h"
 #include "UpdateCheck.h"
 #include <baseresource.h>
@@ -23,7 +28,9 @@ LONG WINAPI GW2TopLevelFilter(struct _EXCEPTION_POINTERS* pExceptionInfo);
 extern LPTOP_LEVEL_EXCEPTION_FILTER previousTopLevelExceptionFilter;
 extern void* vectoredExceptionHandlerHandle;
 
-void BaseCore::Init(HMODULE dll, GW2Load_API& api) {
+void BaseCore::Init(HMODULE dll, HMODULE gw2loadHandle, GW2Load_API& api) {
+    Log::i().AddSink(std::make_unique<LoaderLogSink>(gw2loadHandle, u8(Severity::Warn) | u8(Severity::Error)));
+
     LogInfo("This is {} {}", AddonName, AddonVersionString);
 
     auto osVer = GetOSVersion();
@@ -47,7 +54,10 @@ void BaseCore::Shutdown() {
     SetUnhandledExceptionFilter(previousTopLevelExceptionFilter);
     RemoveVectoredExceptionHandler(vectoredExceptionHandlerHandle);
 
-    g_singletonManagerInstance.Shutdown();
+    // The log is a singleton too, so timings can only be reported while it is still around
+    g_singletonManagerInstance.Shutdown([](const char* name, std::chrono::microseconds duration) {
+        Log::f([&](Log&) { LogInfoUnlimited("Destroyed {} in {} us", name, duration.count()); });
+    });
 }
 
 void BaseCore::OnInputLanguageChange() {
@@ -57,6 +67,7 @@ void BaseCore::OnInputLanguageChange() {
     LogInfo("Input language change detected, reloading...");
     SettingsMenu::i().OnInputLanguageChange();
 
+    keybindLanguageChangeEvent_([](Keybind& kb) { kb.UpdateDisplayString(); });
     languageChangeEvent_();
 }
 
@@ -93,7 +104,47 @@ void BaseCore::InternalInit(HMODULE dll, GW2Load_API& api) {
     ImGui::GetIO().ConfigInputTrickleEventQueue = false;
 
     InnerInternalInit(api);
-    UpdateCheck::init(GetGithubRepoSubUrl());
+    InitSingletons();
+}
+
+void BaseCore::InitSingletons() {
+    SingletonInitializer initializer;
+    initializer.Add<INIConfigurationFile>()
+        .Add<JSONConfigurationFile>()
+        .Add<MumbleLink>()
+        .Add<GFXSettings>()
+        .Add<Input>()
+        .Add<UpdateCheck>([this] { UpdateCheck::init(GetGithubRepoSubUrl()); });
+    InnerInitSingletons(initializer);
+
+    const auto start = std::chrono::steady_clock::now();
+    auto results = initializer.Run();
+    const auto elapsed = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start);
+
+    LogInfo("Initialized {} singletons in {} us", results.size(), elapsed.count());
+    std::exception_ptr firstError;
+    for(const auto& r : results) {
+        if(!r.error) {
+            LogInfoUnlimited("  {}: {} us (wave {})", r.name, r.duration.count(), r.wave);
+            continue;
+        }
+
+        try {
+            std::rethrow_exception(r.error);
+        }
+        catch(const std::exception& e) {
+            LogError("  {}: failed, {}", r.name, e.what());
+        }
+        catch(...) {
+            LogError("  {}: failed", r.name);
+        }
+        if(!firstError)
+            firstError = r.error;
+    }
+
+    // Initialization used to fail on the first exception, keep it that way now that everything has been reported
+    if(firstError)
+        std::rethrow_exception(firstError);
 }
 
 void BaseCore::InternalShutdown() {
@@ -189,7 +240,7 @@ void BaseCore::PostCreateSwapChain(HWND hwnd, ID3D11Device* device, IDXGISwapCha
             DXGI_ADAPTER_DESC desc;
             adapter->GetDesc(&desc);
 
-            LogInfo(L"Graphics adapter is {}", desc.Description);
+            LogInfoCat(Graphics, L"Graphics adapter is {}", desc.Description);
         }
     }
     gameWindow_ = hwnd;
@@ -452,19 +503,26 @@ void BaseCore::Update() {
     if(!active_)
         return;
 
+    deferredEvents_.Drain();
+
     Input::i().OnUpdate();
 
     tickSkip_++;
     if(tickSkip_ >= TickSkipCount) {
         tickSkip_ -= TickSkipCount;
         MumbleLink::i().OnUpdate();
+        // Keep the last character's profile through loading screens and character select
+        if(const auto character = MumbleLink::i().characterName(); !character.empty())
+            INIConfigurationFile::i().profile(utf8_encode(character));
+        // Often enough for debounced saves and external edits to be picked up promptly
+        INIConfigurationFile::i().OnUpdate();
+        JSONConfigurationFile::i().OnUpdate();
         InnerFrequentUpdate();
     }
 
     longTickSkip_++;
     if(longTickSkip_ >= LongTickSkipCount) {
         longTickSkip_ -= LongTickSkipCount;
-        INIConfigurationFile::i().OnUpdate();
         GFXSettings::i().OnUpdate();
         UpdateCheck::i().CheckForUpdates();
 
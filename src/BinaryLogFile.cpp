@@ -0,0 +1,143 @@
+#include "BinaryLogFile.h"
+
+#include <libzippp/libzippp.h>
+
+#include "Log.h"
+#include "Utility.h"
+
+BinaryLogFile::BinaryLogFile(std::filesystem::path path, u64 maxSegmentSize, u32 maxSegments)
+    : path_(std::move(path)), maxSegmentSize_(maxSegmentSize), maxSegments_(maxSegments) {
+    session_ = std::format("{:%Y%m%d-%H%M%S}", std::chrono::floor<std::chrono::seconds>(std::chrono::system_clock::now()));
+    Open();
+}
+
+BinaryLogFile::~BinaryLogFile() {
+    file_.close();
+}
+
+void BinaryLogFile::WriteMessage(i64 time, Severity sev, const LogDetail::Formatter& formatter, const void* fmt, size_t fmtSize,
+                                 std::string_view payload) {
+    if(!isOpen())
+        return;
+
+    const LogFile::MessageHeader header { LogFile::RecordType::Message, time, u8(sev), FormatId(formatter, fmt, fmtSize), u32(payload.size()) };
+    Write(&header, sizeof(header));
+    Write(payload.data(), payload.size());
+
+    if(size_ >= rotateAt_)
+        Rotate();
+}
+
+void BinaryLogFile::WriteText(i64 time, Severity sev, std::string_view text) {
+    if(!isOpen())
+        return;
+
+    const LogFile::TextHeader header { LogFile::RecordType::Text, time, u8(sev), u32(text.size()) };
+    Write(&header, sizeof(header));
+    Write(text.data(), text.size());
+
+    if(size_ >= rotateAt_)
+        Rotate();
+}
+
+void BinaryLogFile::Flush() {
+    file_.flush();
+}
+
+void BinaryLogFile::Open() {
+    file_.open(path_, std::ios::binary | std::ios::trunc);
+    size_ = 0;
+    rotateAt_ = maxSegmentSize_;
+    formatIds_.clear();
+    if(!file_)
+        return;
+
+    using period = std::chrono::system_clock::period;
+    LogFile::FileHeader header {};
+    memcpy(header.magic, LogFile::Magic, sizeof(header.magic));
+    header.version = LogFile::Version;
+    header.pointerSize = u8(sizeof(void*));
+    header.wcharSize = u8(sizeof(wchar_t));
+    header.ticksPerSecond = period::den / period::num;
+    Write(&header, sizeof(header));
+}
+
+void BinaryLogFile::Rotate() {
+    file_.close();
+
+    auto segment = path_;
+    segment.replace_filename(std::format("{}.{}-{:03}{}", path_.stem().string(), session_, ++rotations_, path_.extension().string()));
+    std::error_code ec;
+    std::filesystem::rename(path_, segment, ec);
+    if(ec) {
+        // Usually a viewer or scanner holding the file open. Truncating would lose the segment, so keep appending
+        // to it and try again later.
+        rotations_--;
+        rotateAt_ = size_ + maxSegmentSize_ / 16;
+        file_.open(path_, std::ios::binary | std::ios::app);
+        return;
+    }
+
+    Open();
+
+    // Compressing a full segment takes a while, don't hold up logging for it
+    if(compressor_.joinable())
+        compressor_.join();
+    compressor_ = std::jthread([this, segment] {
+        auto archive = segment;
+        archive += ".zip";
+
+        libzippp::ZipArchive zip(archive.string());
+        if(zip.open(libzippp::ZipArchive::New) && zip.addFile(segment.filename().string(), segment.string()) && zip.close() == LIBZIPPP_OK) {
+            std::error_code ec;
+            std::filesystem::remove(segment, ec);
+        }
+        else
+            zip.unlink();
+
+        PruneSegments();
+    });
+}
+
+void BinaryLogFile::PruneSegments() const {
+    const auto prefix = path_.stem().string() + ".";
+    std::vector<std::filesystem::path> archives;
+    std::error_code ec;
+    for(const auto& entry : std::filesystem::directory_iterator(path_.parent_path(), ec)) {
+        const auto name = entry.path().filename().string();
+        if(name.starts_with(prefix) && name.ends_with(".zip"))
+            archives.push_back(entry.path());
+    }
+
+    if(archives.size() <= maxSegments_)
+        return;
+
+    // Session timestamps and zero-padded indices make names sort chronologically
+    std::ranges::sort(archives);
+    for(size_t i = 0; i < archives.size() - maxSegments_; i++)
+        std::filesystem::remove(archives[i], ec);
+}
+
+u32 BinaryLogFile::FormatId(const LogDetail::Formatter& formatter, const void* fmt, size_t fmtSize) {
+    const auto [it, inserted] = formatIds_.try_emplace({ fmt, &formatter }, u32(formatIds_.size()));
+    if(!inserted)
+        return it->second;
+
+    std::string format;
+    if(formatter.wide)
+        format = utf8_encode(std::wstring(static_cast<const wchar_t*>(fmt), fmtSize));
+    else
+        format.assign(static_cast<const char*>(fmt), fmtSize);
+
+    const LogFile::FormatDefHeader header { LogFile::RecordType::FormatDef, it->second, formatter.argCount, u32(format.size()) };
+    Write(&header, sizeof(header));
+    Write(formatter.argTypes, formatter.argCount);
+    Write(format.data(), format.size());
+
+    return it->second;
+}
+
+void BinaryLogFile::Write(const void* data, size_t size) {
+    file_.write(static_cast<const char*>(data), std::streamsize(size));
+    size_ += size;
+}
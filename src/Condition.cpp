@@ -86,9 +86,8 @@ bool IsCharacterCondition::DrawInnerMenu() {
 
 void ConditionSet::Load() {
     const char* c = category_.c_str();
-    const auto& ini = INIConfigurationFile::i().ini();
 
-    const char* set = ini.GetValue(c, "condition_set", "");
+    const char* set = INIConfigurationFile::i().GetString(setKey_, "");
     if(strlen(set) == 0)
         return;
 
@@ -131,7 +130,10 @@ void ConditionSet::Load() {
     }
 }
 
-ConditionSet::ConditionSet(std::string category) : category_(std::move(category)) { Load(); }
+ConditionSet::ConditionSet(std::string category)
+    : category_(std::move(category)), setKey_(INIConfigurationFile::i().Resolve(category_, "condition_set")) {
+    Load();
+}
 
 bool ConditionSet::passes() const {
     if(!enabled_)
@@ -174,7 +176,7 @@ void ConditionSet::Save() const {
         set << c.condition->id() << "/" << c.condition->nickname() << ", ";
     }
 
-    INIConfigurationFile::i().ini().SetValue(cat, "condition_set", set.str().substr(0, set.str().size() - 2).c_str());
+    INIConfigurationFile::i().SetString(setKey_, set.str().substr(0, set.str().size() - 2));
 }
 
 bool Condition::DrawMenu(const char* category, MenuResult& mr, bool isFirst, bool isLast) {
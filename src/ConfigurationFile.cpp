@@ -1,7 +1,10 @@
 #include "ConfigurationFile.h"
 
+#include <algorithm>
+#include <charconv>
 #include <filesystem>
 #include <sstream>
+#include <utility>
 
 #include <tchar.h>
 
@@ -12,30 +15,433 @@ const std::wstring_view JSONConfigurationFile::ConfigFileName = L"config.json";
 
 const std::wstring_view g_imguiConfigName = L"imgui_config.ini";
 
-INIConfigurationFile::INIConfigurationFile() { Reload(); }
+namespace
+{
+
+std::string LastErrorMessage(DWORD error = GetLastError()) {
+    return std::system_category().message(int(error));
+}
+
+// Goes through a temporary file so that a crash or full disk can never leave a truncated config behind
+std::string WriteAtomically(const std::filesystem::path& path, const std::string& contents) {
+    auto tmp = path;
+    tmp += L".tmp";
+
+    HANDLE file = CreateFileW(tmp.c_str(), GENERIC_WRITE, 0, nullptr, CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if(file == INVALID_HANDLE_VALUE)
+        return LastErrorMessage();
+
+    DWORD written = 0;
+    const bool ok = WriteFile(file, contents.data(), DWORD(contents.size()), &written, nullptr) && written == contents.size() &&
+                    FlushFileBuffers(file);
+    const DWORD error = ok ? ERROR_SUCCESS : GetLastError();
+    CloseHandle(file);
+
+    if(ok && MoveFileExW(tmp.c_str(), path.c_str(), MOVEFILE_REPLACE_EXISTING | MOVEFILE_WRITE_THROUGH))
+        return {};
+
+    auto message = LastErrorMessage(ok ? GetLastError() : error);
+    DeleteFileW(tmp.c_str());
+    return message;
+}
+
+std::string AppendToFile(const std::filesystem::path& path, std::string_view contents, bool truncate) {
+    HANDLE file = CreateFileW(path.c_str(), truncate ? GENERIC_WRITE : FILE_APPEND_DATA, FILE_SHARE_READ, nullptr,
+                              truncate ? CREATE_ALWAYS : OPEN_ALWAYS, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if(file == INVALID_HANDLE_VALUE)
+        return LastErrorMessage();
+
+    DWORD written = 0;
+    const bool ok = WriteFile(file, contents.data(), DWORD(contents.size()), &written, nullptr) && written == contents.size() &&
+                    FlushFileBuffers(file);
+    const DWORD error = ok ? ERROR_SUCCESS : GetLastError();
+    CloseHandle(file);
+
+    return ok ? std::string() : LastErrorMessage(error);
+}
+
+std::string ReadFileContents(const std::filesystem::path& path) {
+    std::ifstream file(path, std::ifstream::binary);
+    if(!file.good())
+        return {};
+
+    std::stringstream ss;
+    ss << file.rdbuf();
+    return ss.str();
+}
+
+// Read-only view of a whole file, so it can be parsed in place
+class MappedFile
+{
+public:
+    explicit MappedFile(const std::filesystem::path& path) {
+        file_ = CreateFileW(path.c_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE, nullptr, OPEN_EXISTING,
+                            FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+        if(file_ == INVALID_HANDLE_VALUE)
+            return;
+
+        BY_HANDLE_FILE_INFORMATION info;
+        if(!GetFileInformationByHandle(file_, &info))
+            return;
+        size_ = (u64(info.nFileSizeHigh) << 32) | info.nFileSizeLow;
+        writeTime_ = (u64(info.ftLastWriteTime.dwHighDateTime) << 32) | info.ftLastWriteTime.dwLowDateTime;
+
+        // Empty files cannot be mapped
+        if(size_ == 0) {
+            open_ = true;
+            return;
+        }
+
+        mapping_ = CreateFileMappingW(file_, nullptr, PAGE_READONLY, 0, 0, nullptr);
+        if(!mapping_)
+            return;
+        view_ = static_cast<const char*>(MapViewOfFile(mapping_, FILE_MAP_READ, 0, 0, 0));
+        open_ = view_ != nullptr;
+    }
+
+    ~MappedFile() {
+        if(view_)
+            UnmapViewOfFile(view_);
+        if(mapping_)
+            CloseHandle(mapping_);
+        if(file_ != INVALID_HANDLE_VALUE)
+            CloseHandle(file_);
+    }
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    [[nodiscard]] bool isOpen() const { return open_; }
+    [[nodiscard]] std::string_view contents() const { return { view_, size_t(view_ ? size_ : 0) }; }
+    [[nodiscard]] u64 size() const { return size_; }
+    [[nodiscard]] u64 writeTime() const { return writeTime_; }
+
+private:
+    HANDLE file_ = INVALID_HANDLE_VALUE;
+    HANDLE mapping_ = nullptr;
+    const char* view_ = nullptr;
+    u64 size_ = 0;
+    u64 writeTime_ = 0;
+    bool open_ = false;
+};
+
+// Parsed config.json in CBOR, loaded instead of the text for as long as it was made from the same file. Size and
+// write time alone can miss edits within the timestamp resolution, so the hash of the text has to match as well.
+struct JsonCacheHeader
+{
+    static constexpr char Magic[8] = { 'G', 'W', '2', 'J', 'S', 'O', 'N', 'C' };
+    static constexpr u32 Version = 1;
+
+    char magic[8];
+    u32 version;
+    u32 headerSize;
+    u64 sourceSize;
+    u64 sourceWriteTime;
+    u64 sourceHash;
+};
+
+std::filesystem::path JsonCachePath(const std::filesystem::path& config) {
+    auto path = config;
+    path += L".cache";
+    return path;
+}
+
+std::optional<nlohmann::json> LoadJsonCache(const std::filesystem::path& config, const MappedFile& source, u64 hash) {
+    const MappedFile cache(JsonCachePath(config));
+    const auto contents = cache.contents();
+    if(contents.size() < sizeof(JsonCacheHeader))
+        return std::nullopt;
+
+    JsonCacheHeader header;
+    memcpy(&header, contents.data(), sizeof(header));
+    if(memcmp(header.magic, JsonCacheHeader::Magic, sizeof(header.magic)) != 0 || header.version != JsonCacheHeader::Version ||
+       header.headerSize != sizeof(header) || header.sourceSize != source.size() || header.sourceWriteTime != source.writeTime() ||
+       header.sourceHash != hash)
+        return std::nullopt;
+
+    const auto cbor = contents.substr(sizeof(header));
+    auto json = nlohmann::json::from_cbor(cbor.begin(), cbor.end(), true, false);
+    if(json.is_discarded())
+        return std::nullopt;
+    return json;
+}
+
+// Failing is harmless, the text is simply parsed again next time
+void StoreJsonCache(const std::filesystem::path& config, const nlohmann::json& json) {
+    const MappedFile source(config);
+    if(!source.isOpen())
+        return;
+
+    JsonCacheHeader header;
+    memcpy(header.magic, JsonCacheHeader::Magic, sizeof(header.magic));
+    header.version = JsonCacheHeader::Version;
+    header.headerSize = sizeof(header);
+    header.sourceSize = source.size();
+    header.sourceWriteTime = source.writeTime();
+    header.sourceHash = Fnv1a(source.contents());
+
+    std::string contents(reinterpret_cast<const char*>(&header), sizeof(header));
+    nlohmann::json::to_cbor(json, nlohmann::detail::output_adapter<char>(contents));
+    if(auto error = WriteAtomically(JsonCachePath(config), contents); !error.empty())
+        LogDebugCat(Config, "Could not write config.json cache: {}", error);
+}
+
+std::filesystem::path JournalPath(const std::filesystem::path& config) {
+    auto path = config;
+    path += L".journal";
+    return path;
+}
+
+// The journal starts with "#<hash>" of the INI it applies to. Each change is a line of its own, "+section\tkey\tvalue"
+// or "-section\tkey" for removals, with tabs, line breaks and backslashes escaped. A line cut short by a crash lacks
+// its terminator and is dropped.
+std::string JournalHeader(u64 baseHash) {
+    return std::format("#{:016x}\n", baseHash);
+}
+
+void AppendEscaped(std::string& out, std::string_view text) {
+    for(const char c : text) {
+        switch(c) {
+        case '\\':
+            out += "\\\\";
+            break;
+        case '\t':
+            out += "\\t";
+            break;
+        case '\n':
+            out += "\\n";
+            break;
+        case '\r':
+            out += "\\r";
+            break;
+        default:
+            out += c;
+        }
+    }
+}
+
+std::string Unescape(std::string_view text) {
+    std::string out;
+    out.reserve(text.size());
+    for(size_t i = 0; i < text.size(); i++) {
+        if(text[i] != '\\' || i + 1 == text.size()) {
+            out += text[i];
+            continue;
+        }
+
+        switch(text[++i]) {
+        case 't':
+            out += '\t';
+            break;
+        case 'n':
+            out += '\n';
+            break;
+        case 'r':
+            out += '\r';
+            break;
+        default:
+            out += text[i];
+        }
+    }
+    return out;
+}
+
+void AppendJournalRecord(std::string& out, const char* section, const char* key, const char* value) {
+    out += value ? '+' : '-';
+    AppendEscaped(out, section);
+    out += '\t';
+    AppendEscaped(out, key);
+    if(value) {
+        out += '\t';
+        AppendEscaped(out, value);
+    }
+    out += '\n';
+}
+
+void ReplayJournal(CSimpleIniA& ini, std::string_view journal) {
+    std::vector<std::string> fields;
+    for(size_t end; (end = journal.find('\n')) != std::string_view::npos; journal.remove_prefix(end + 1)) {
+        auto line = journal.substr(0, end);
+        if(line.empty() || (line[0] != '+' && line[0] != '-'))
+            continue;
+
+        const bool set = line[0] == '+';
+        line.remove_prefix(1);
+
+        fields.clear();
+        SplitString(line, "\t", std::back_inserter(fields));
+        if(set && fields.size() == 3)
+            ini.SetValue(Unescape(fields[0]).c_str(), Unescape(fields[1]).c_str(), Unescape(fields[2]).c_str());
+        else if(!set && fields.size() == 2)
+            ini.Delete(Unescape(fields[0]).c_str(), Unescape(fields[1]).c_str());
+    }
+}
+
+// Keys are case-insensitive in the INI as well
+std::string EntryName(std::string_view section, std::string_view key) {
+    std::string name = ToLower(section);
+    name += '\0';
+    name += ToLower(key);
+    return name;
+}
+
+// "section@character" holds the overrides of a character, which cannot contain an @ itself
+std::pair<std::string_view, std::string_view> SplitProfileSection(std::string_view section) {
+    const size_t at = section.rfind('@');
+    if(at == std::string_view::npos)
+        return { section, {} };
+    return { section.substr(0, at), section.substr(at + 1) };
+}
+
+std::string ProfileSection(std::string_view section, std::string_view character) {
+    std::string name(section);
+    name += '@';
+    name += character;
+    return name;
+}
+
+struct IniChange
+{
+    std::string section, key;
+    // Empty if removed
+    std::optional<std::string> value;
+};
+
+std::vector<IniChange> DiffIni(const CSimpleIniA& before, const CSimpleIniA& after) {
+    std::vector<IniChange> changes;
+    CSimpleIniA::TNamesDepend sections, keys;
+
+    after.GetAllSections(sections);
+    for(const auto& section : sections) {
+        after.GetAllKeys(section.pItem, keys);
+        for(const auto& key : keys) {
+            const char* value = after.GetValue(section.pItem, key.pItem, "");
+            const char* previous = before.GetValue(section.pItem, key.pItem);
+            if(!previous || strcmp(previous, value) != 0)
+                changes.push_back({ section.pItem, key.pItem, value });
+        }
+    }
+
+    before.GetAllSections(sections);
+    for(const auto& section : sections) {
+        before.GetAllKeys(section.pItem, keys);
+        for(const auto& key : keys) {
+            if(!after.GetValue(section.pItem, key.pItem))
+                changes.push_back({ section.pItem, key.pItem, std::nullopt });
+        }
+    }
+
+    return changes;
+}
+
+// Same rules as CSimpleIni::GetBoolValue
+std::optional<bool> ParseBool(std::string_view text) {
+    if(text.empty())
+        return std::nullopt;
+
+    switch(text[0]) {
+    case 't':
+    case 'T':
+    case 'y':
+    case 'Y':
+    case '1':
+        return true;
+    case 'f':
+    case 'F':
+    case 'n':
+    case 'N':
+    case '0':
+        return false;
+    case 'o':
+    case 'O':
+        if(text.size() > 1 && (text[1] == 'n' || text[1] == 'N'))
+            return true;
+        if(text.size() > 1 && (text[1] == 'f' || text[1] == 'F'))
+            return false;
+        break;
+    }
+    return std::nullopt;
+}
+
+// Same rules as CSimpleIni::GetLongValue, decimal or 0x-prefixed hexadecimal
+std::optional<i64> ParseInt(std::string_view text) {
+    const bool negative = text.starts_with('-');
+    if(negative)
+        text.remove_prefix(1);
+
+    int base = 10;
+    if(text.starts_with("0x") || text.starts_with("0X")) {
+        text.remove_prefix(2);
+        base = 16;
+    }
+
+    i64 value;
+    if(const auto [ptr, ec] = std::from_chars(text.data(), text.data() + text.size(), value, base); ec != std::errc() || ptr == text.data())
+        return std::nullopt;
+    return negative ? -value : value;
+}
+
+std::optional<double> ParseDouble(std::string_view text) {
+    double value;
+    if(const auto [ptr, ec] = std::from_chars(text.data(), text.data() + text.size(), value); ec != std::errc() || ptr == text.data())
+        return std::nullopt;
+    return value;
+}
+
+}
+
+INIConfigurationFile::INIConfigurationFile() {
+    journaled_.SetUnicode();
+    Reload();
+    writer_ = std::jthread([this](std::stop_token stop) { WriterLoop(stop); });
+}
+
+INIConfigurationFile::~INIConfigurationFile() {
+    Flush();
+}
+
+ConfigurationFile::~ConfigurationFile() {
+    if(watch_)
+        FileWatcher::f([&](FileWatcher& watcher) { watcher.Unwatch(*watch_); });
+}
+
+void ConfigurationFile::WatchFile() {
+    auto& watcher = FileWatcher::i();
+    if(watch_)
+        watcher.Unwatch(*std::exchange(watch_, std::nullopt));
+    if(folder_)
+        watch_ = watcher.Watch(*folder_ / configFileName(), [this](const std::filesystem::path&) { externalChange_ = true; });
+}
+
+void ConfigurationFile::OnUpdate() {
+    if(externalChange_.exchange(false))
+        ApplyExternalChanges();
+}
 
 JSONConfigurationFile::JSONConfigurationFile() { Reload(); }
 
 void ConfigurationFile::Reload() {
-    LogDebug("Reloading configuration files");
+    LogDebugCat(Config, "Reloading configuration files");
     readOnlyWarned_ = false;
 
     auto folder = GetAddonFolder();
     if(!folder) {
-        LogWarn("Could not find addon folder");
+        LogWarnCat(Config, "Could not find addon folder");
         folder_ = std::nullopt;
         readOnly_ = false;
+        WatchFile();
         return;
     }
 
     auto cfgFile = *folder / configFileName();
     FILE* fp = nullptr;
     if(_wfopen_s(&fp, cfgFile.c_str(), L"ab") != 0) {
-        LogWarn(L"Could not write to config file '{}'", cfgFile.wstring());
+        LogWarnCat(Config, L"Could not write to config file '{}'", cfgFile.wstring());
         if(_wfopen_s(&fp, cfgFile.c_str(), L"rb") != 0) {
-            LogError(L"Could read config file '{}'", cfgFile.wstring());
+            LogErrorCat(Config, L"Could read config file '{}'", cfgFile.wstring());
             folder_ = std::nullopt;
             readOnly_ = false;
+            WatchFile();
             return;
         }
         else if(fp)
@@ -45,19 +451,386 @@ void ConfigurationFile::Reload() {
     else if(fp)
         fclose(fp);
     folder_ = folder;
+    WatchFile();
 
-    LogInfo(L"Config folder is now '{}'", folder_->wstring());
+    LogInfoCat(Config, L"Config folder is now '{}'", folder_->wstring());
 }
 
 void INIConfigurationFile::Reload() {
+    // Pending changes belong to the file as it was before reloading
+    Flush();
     ConfigurationFile::Reload();
 
     if(folder_) {
         LoadImGuiSettings(*folder_ / g_imguiConfigName);
 
+        const auto path = *folder_ / ConfigFileName;
+        auto contents = ReadFileContents(path);
+        const u64 hash = Fnv1a(contents);
+        diskContents_ = contents;
+        diskHash_ = hash;
         ini_.SetUnicode();
-        ini_.LoadFile((*folder_ / ConfigFileName).c_str());
+        ini_.LoadData(contents);
+
+        const auto journal = ReadFileContents(JournalPath(path));
+        if(journal.starts_with(JournalHeader(hash)))
+            ReplayJournal(ini_, journal);
+        else if(!journal.empty())
+            LogWarnCat(Config, "Discarding configuration journal, it does not belong to the current config.ini");
+
+        const bool migrated = RunMigrations();
+
+        dirtyEntries_.clear();
+        dirtyOverrides_.clear();
+        iniModified_ = false;
+        for(auto& e : entries_)
+            e.dirty = false;
+        LoadEntries();
+
+        if(!readOnly_) {
+            // Fold whatever the last session journaled or migrated back into the INI
+            if(journal.empty() && !migrated)
+                Queue({ WriteJob::Kind::Rebase, path, std::move(contents), hash });
+            else if(auto compacted = Serialize())
+                Queue({ WriteJob::Kind::Compact, path, std::move(*compacted) });
+        }
+    }
+}
+
+ConfigKey INIConfigurationFile::Resolve(std::string_view section, std::string_view key, ConfigType type) {
+    if(unclaimedStale_)
+        IndexValues(false);
+
+    auto [it, inserted] = entryIndices_.try_emplace(EntryName(section, key), u32(entries_.size()));
+    if(inserted) {
+        auto& e = entries_.emplace_back(std::string(section), std::string(key));
+        e.type = type;
+        Claim(it->second, it->first);
+    }
+    else if(type != ConfigType::Text)
+        entries_[it->second].type = type; // Whatever is still text gets parsed on access
+
+    return ConfigKey(it->second);
+}
+
+std::vector<ConfigMigration>& INIConfigurationFile::migrations() {
+    static std::vector<ConfigMigration> migrations;
+    return migrations;
+}
+
+bool INIConfigurationFile::RegisterMigration(ConfigMigration migration) {
+    migrations().push_back(std::move(migration));
+    return true;
+}
+
+bool INIConfigurationFile::RunMigrations() {
+    auto pending = migrations();
+    std::ranges::stable_sort(pending, {}, &ConfigMigration::version);
+
+    bool migrated = false;
+    for(const auto& m : pending) {
+        if(m.version <= u32(ini_.GetLongValue("ConfigVersions", m.scope.c_str(), 0)))
+            continue;
+
+        LogInfoCat(Config, "Migrating {} configuration to version {}", m.scope, m.version);
+        m.migrate(ini_);
+        ini_.SetLongValue("ConfigVersions", m.scope.c_str(), long(m.version));
+        migrated = true;
+    }
+
+    return migrated;
+}
+
+void INIConfigurationFile::profile(std::string_view character) {
+    if(character == profile_)
+        return;
+
+    const auto* previous = activeLayer_;
+    profile_ = character;
+    const auto it = profiles_.find(profile_);
+    activeLayer_ = it != profiles_.end() ? &it->second : &emptyLayer_;
+    profileGeneration_++;
+    LogInfoCat(Config, "Switched to configuration profile '{}', {} overrides", profile_, activeLayer_->values.size());
+
+    std::vector<u32> changed;
+    for(const auto* layer : { previous, static_cast<const ProfileLayer*>(activeLayer_) }) {
+        for(const auto& [index, value] : layer->values) {
+            if(std::ranges::find(changed, index) == changed.end())
+                changed.push_back(index);
+        }
+    }
+    RunChangeCallbacks(changed);
+}
+
+void INIConfigurationFile::Override(ConfigKey key) {
+    if(profile_.empty() || IsOverridden(key))
+        return;
+
+    MutableLayer(profile_).values[key.index_] = entries_[key.index_].value;
+    MarkOverrideDirty(profile_, key.index_);
+}
+
+void INIConfigurationFile::ClearOverride(ConfigKey key) {
+    if(!IsOverridden(key))
+        return;
+
+    MutableLayer(profile_).values.erase(key.index_);
+    MarkOverrideDirty(profile_, key.index_);
+}
+
+INIConfigurationFile::ProfileLayer& INIConfigurationFile::MutableLayer(const std::string& character) {
+    auto& layer = profiles_[character];
+    if(character == profile_)
+        activeLayer_ = &layer;
+    return layer;
+}
+
+void INIConfigurationFile::MarkOverrideDirty(const std::string& character, u32 index) {
+    if(std::ranges::find(dirtyOverrides_, std::pair(character, index)) == dirtyOverrides_.end())
+        dirtyOverrides_.emplace_back(character, index);
+}
+
+void INIConfigurationFile::RunChangeCallbacks(std::span<const u32> indices) {
+    for(u32 index : indices) {
+        // Callbacks may add or remove others
+        const auto callbacks = entries_[index].callbacks;
+        for(const auto& [id, callback] : callbacks)
+            callback();
+    }
+}
+
+EventCallbackHandle INIConfigurationFile::AddChangeCallback(ConfigKey key, ChangeCallback callback) {
+    const i32 id = nextCallbackId_++;
+    entries_[key.index_].callbacks.emplace_back(id, std::move(callback));
+    return { id };
+}
+
+void INIConfigurationFile::RemoveChangeCallback(ConfigKey key, EventCallbackHandle&& handle) {
+    if(!key.valid() || handle.id() < 0)
+        return;
+
+    std::erase_if(entries_[key.index_].callbacks, [&](const auto& cb) { return cb.first == handle.id(); });
+}
+
+void INIConfigurationFile::LoadEntry(Entry& e) const {
+    e.value = ParseValue(e.type, ini_.GetValue(e.section.c_str(), e.key.c_str()));
+}
+
+INIConfigurationFile::Value INIConfigurationFile::ParseValue(ConfigType type, const char* text) {
+    if(!text)
+        return std::monostate {};
+
+    switch(type) {
+    case ConfigType::Bool:
+        if(const auto v = ParseBool(text))
+            return *v;
+        break;
+    case ConfigType::Int:
+        if(const auto v = ParseInt(text))
+            return *v;
+        break;
+    case ConfigType::Double:
+        if(const auto v = ParseDouble(text))
+            return *v;
+        break;
+    default:
+        break;
+    }
+
+    // Kept as is when malformed, so that the getters fall back to their defaults without losing it
+    return Text { text };
+}
+
+void INIConfigurationFile::LoadEntries() {
+    for(auto& e : entries_)
+        e.value = std::monostate {};
+    profiles_.clear();
+    activeLayer_ = &emptyLayer_;
+
+    IndexValues(true);
+
+    const auto it = profiles_.find(profile_);
+    activeLayer_ = it != profiles_.end() ? &it->second : &emptyLayer_;
+}
+
+void INIConfigurationFile::IndexValues(bool loadEntries) {
+    unclaimed_.clear();
+    unclaimedStale_ = false;
+
+    CSimpleIniA::TNamesDepend sections;
+    ini_.GetAllSections(sections);
+    for(const auto& section : sections) {
+        const auto* keys = ini_.GetSection(section.pItem);
+        if(!keys)
+            continue;
+
+        const auto [name, character] = SplitProfileSection(section.pItem);
+        ProfileLayer* layer = nullptr;
+        for(const auto& [key, value] : *keys) {
+            auto entryName = EntryName(name, key.pItem);
+            const auto it = entryIndices_.find(entryName);
+            if(it == entryIndices_.end()) {
+                auto& v = unclaimed_[std::move(entryName)];
+                if(character.empty())
+                    v.text = value;
+                else
+                    v.overrides.emplace_back(character, value);
+                continue;
+            }
+            if(!loadEntries)
+                continue;
+
+            auto& e = entries_[it->second];
+            if(character.empty())
+                e.value = ParseValue(e.type, value);
+            else {
+                if(!layer)
+                    layer = &MutableLayer(std::string(character));
+                layer->values[it->second] = ParseValue(e.type, value);
+            }
+        }
+    }
+}
+
+void INIConfigurationFile::Claim(u32 index, const std::string& name) {
+    auto& e = entries_[index];
+    auto node = unclaimed_.extract(name);
+    if(!node) {
+        e.value = std::monostate {};
+        return;
+    }
+
+    const auto& v = node.mapped();
+    e.value = ParseValue(e.type, v.text ? v.text->c_str() : nullptr);
+    for(const auto& [character, text] : v.overrides)
+        MutableLayer(character).values[index] = ParseValue(e.type, text.c_str());
+}
+
+bool INIConfigurationFile::GetBool(ConfigKey key, bool defaultValue) {
+    auto& value = this->value(key);
+    if(auto* text = std::get_if<Text>(&value)) {
+        const auto parsed = ParseBool(text->value);
+        if(!parsed)
+            return defaultValue;
+        value = *parsed;
+    }
+
+    if(auto* b = std::get_if<bool>(&value))
+        return *b;
+    if(auto* n = std::get_if<i64>(&value))
+        return *n != 0;
+    return defaultValue;
+}
+
+i64 INIConfigurationFile::GetInt(ConfigKey key, i64 defaultValue) {
+    auto& value = this->value(key);
+    if(auto* text = std::get_if<Text>(&value)) {
+        const auto parsed = ParseInt(text->value);
+        if(!parsed)
+            return defaultValue;
+        value = *parsed;
     }
+
+    if(auto* n = std::get_if<i64>(&value))
+        return *n;
+    if(auto* b = std::get_if<bool>(&value))
+        return *b ? 1 : 0;
+    if(auto* d = std::get_if<double>(&value))
+        return i64(*d);
+    return defaultValue;
+}
+
+double INIConfigurationFile::GetDouble(ConfigKey key, double defaultValue) {
+    auto& value = this->value(key);
+    if(auto* text = std::get_if<Text>(&value)) {
+        const auto parsed = ParseDouble(text->value);
+        if(!parsed)
+            return defaultValue;
+        value = *parsed;
+    }
+
+    if(auto* d = std::get_if<double>(&value))
+        return *d;
+    if(auto* n = std::get_if<i64>(&value))
+        return double(*n);
+    return defaultValue;
+}
+
+const char* INIConfigurationFile::GetString(ConfigKey key, const char* defaultValue) {
+    const auto& value = this->value(key);
+    if(const auto* text = std::get_if<Text>(&value))
+        return text->value.c_str();
+    if(const auto* str = std::get_if<std::string>(&value))
+        return str->c_str();
+    return defaultValue;
+}
+
+INIConfigurationFile::Value& INIConfigurationFile::value(ConfigKey key) {
+    if(const auto it = activeLayer_->values.find(key.index_); it != activeLayer_->values.end())
+        return it->second;
+    return entries_[key.index_].value;
+}
+
+void INIConfigurationFile::Set(ConfigKey key, Value value) {
+    if(IsOverridden(key)) {
+        MutableLayer(profile_).values[key.index_] = std::move(value);
+        MarkOverrideDirty(profile_, key.index_);
+        return;
+    }
+
+    auto& e = entries_[key.index_];
+    e.value = std::move(value);
+    if(!e.dirty) {
+        e.dirty = true;
+        dirtyEntries_.push_back(key.index_);
+    }
+}
+
+void INIConfigurationFile::StoreValue(const char* section, const char* key, const Value& value) {
+    std::visit(
+        [&]<typename T>(const T& v) {
+            if constexpr(std::is_same_v<T, std::monostate>)
+                ini_.Delete(section, key);
+            else if constexpr(std::is_same_v<T, Text>)
+                ini_.SetValue(section, key, v.value.c_str());
+            else if constexpr(std::is_same_v<T, bool>)
+                ini_.SetBoolValue(section, key, v);
+            else if constexpr(std::is_same_v<T, i64>)
+                ini_.SetLongValue(section, key, long(v));
+            else if constexpr(std::is_same_v<T, double>)
+                ini_.SetDoubleValue(section, key, v);
+            else
+                ini_.SetValue(section, key, v.c_str());
+        },
+        value);
+}
+
+std::string INIConfigurationFile::StoreDirtyEntries() {
+    std::string records;
+    for(u32 index : dirtyEntries_) {
+        auto& e = entries_[index];
+        StoreValue(e.section.c_str(), e.key.c_str(), e.value);
+        AppendJournalRecord(records, e.section.c_str(), e.key.c_str(), ini_.GetValue(e.section.c_str(), e.key.c_str()));
+        e.dirty = false;
+    }
+    dirtyEntries_.clear();
+
+    for(const auto& [character, index] : dirtyOverrides_) {
+        const auto& e = entries_[index];
+        const auto section = ProfileSection(e.section, character);
+        const auto& values = profiles_[character].values;
+        const auto it = values.find(index);
+        if(it == values.end())
+            ini_.Delete(section.c_str(), e.key.c_str(), true);
+        else if(std::holds_alternative<std::monostate>(it->second))
+            ini_.SetValue(section.c_str(), e.key.c_str(), ""); // Erased for the character only, it stays overridden
+        else
+            StoreValue(section.c_str(), e.key.c_str(), it->second);
+        AppendJournalRecord(records, section.c_str(), e.key.c_str(), ini_.GetValue(section.c_str(), e.key.c_str()));
+    }
+    dirtyOverrides_.clear();
+
+    return records;
 }
 
 void JSONConfigurationFile::Reload() {
@@ -65,17 +838,55 @@ void JSONConfigurationFile::Reload() {
 
     if(folder_) {
         json_.clear();
-        std::ifstream cfg(*folder_ / ConfigFileName);
-        if(cfg.good()) {
-            std::stringstream ss;
-            ss << cfg.rdbuf();
-            auto str = ss.str();
-            if(!str.empty())
-                json_ = nlohmann::json::parse(str, nullptr, false, true);
+        const auto path = *folder_ / ConfigFileName;
+        const MappedFile cfg(path);
+        if(cfg.isOpen()) {
+            const auto contents = cfg.contents();
+            diskHash_ = Fnv1a(contents);
+            if(auto cached = LoadJsonCache(path, cfg, diskHash_))
+                json_ = std::move(*cached);
+            else if(!contents.empty()) {
+                json_ = nlohmann::json::parse(contents.begin(), contents.end(), nullptr, false, true);
+                if(!readOnly_ && !json_.is_discarded())
+                    StoreJsonCache(path, json_);
+            }
         }
     }
 }
 
+void JSONConfigurationFile::ApplyExternalChanges() {
+    if(!folder_)
+        return;
+
+    const auto path = *folder_ / ConfigFileName;
+    const MappedFile cfg(path);
+    if(!cfg.isOpen())
+        return;
+    const auto contents = cfg.contents();
+
+    const u64 hash = Fnv1a(contents);
+    if(hash == diskHash_)
+        return;
+    diskHash_ = hash;
+
+    auto json = contents.empty() ? nlohmann::json {} : nlohmann::json::parse(contents.begin(), contents.end(), nullptr, false, true);
+    if(json.is_discarded()) {
+        // Most likely caught mid-edit, the next save of the file will be picked up again
+        LogWarnCat(Config, "Ignoring external edit of config.json, the file could not be parsed");
+        return;
+    }
+
+    if(!readOnly_)
+        StoreJsonCache(path, json);
+
+    const auto patch = nlohmann::json::diff(json_, json);
+    json_ = std::move(json);
+    LogInfoCat(Config, "config.json was edited externally, {} values changed", patch.size());
+
+    for(const auto& op : patch)
+        externalChangeEvent_(nlohmann::json::json_pointer(op["path"].get<std::string>()));
+}
+
 void ConfigurationFile::Save() {
     if(!folder_) {
         const auto prevSaveError = lastSaveError_;
@@ -86,7 +897,7 @@ void ConfigurationFile::Save() {
 
     if(readOnly_) {
         if(!readOnlyWarned_) {
-            LogWarn("Configuration files in read-only mode, changes will not be saved!");
+            LogWarnCat(Config, "Configuration files in read-only mode, changes will not be saved!");
             readOnlyWarned_ = true;
         }
         return;
@@ -98,36 +909,159 @@ void INIConfigurationFile::Save() {
     if(!folder_ || readOnly_)
         return;
 
-    const auto r = ini_.SaveFile((*folder_ / ConfigFileName).c_str());
+    const auto now = std::chrono::steady_clock::now();
+    if(!dirtySince_)
+        dirtySince_ = now;
+    saveDeadline_ = std::min(now + SaveDebounce, *dirtySince_ + SaveMaxDelay);
+}
 
-    if(r < 0) {
-        const auto prevSaveError = lastSaveError_;
-        switch(r) {
-        case SI_FAIL:
-            lastSaveError_ = "Unknown error";
-            break;
-        case SI_NOMEM:
-            lastSaveError_ = "Out of memory";
-            break;
-        case SI_FILE:
-            char buf[1024];
-            if(strerror_s(buf, errno) == 0) {
-                buf[1023] = '\0';
-                lastSaveError_.assign(buf);
-            }
-            else
-                lastSaveError_ = "Unknown error";
-            break;
-        default:
-            lastSaveError_ = "Unknown error";
+void INIConfigurationFile::Flush() {
+    if(dirtySince_)
+        QueueChanges();
+
+    std::unique_lock lock(writerMutex_);
+    // Whatever the writer has in flight must land first, the rest is run right here
+    writerCv_.wait(lock, [&] { return !writing_; });
+    if(!pendingJobs_.empty())
+        RunJobs(lock);
+    lock.unlock();
+
+    CollectWriteResult();
+}
+
+std::optional<std::string> INIConfigurationFile::Serialize() {
+    std::string contents;
+    if(const auto r = ini_.Save(contents, true); r < 0) {
+        SaveError(r == SI_NOMEM ? "Out of memory" : "Unknown error");
+        return std::nullopt;
+    }
+    return contents;
+}
+
+void INIConfigurationFile::QueueChanges() {
+    dirtySince_.reset();
+    auto records = StoreDirtyEntries();
+    if(!folder_ || readOnly_)
+        return;
+
+    const auto path = *folder_ / ConfigFileName;
+    if(std::exchange(iniModified_, false)) {
+        if(auto contents = Serialize())
+            Queue({ WriteJob::Kind::Compact, path, std::move(*contents) });
+    }
+    else if(!records.empty())
+        Queue({ WriteJob::Kind::Append, path, std::move(records) });
+}
+
+void INIConfigurationFile::Queue(WriteJob job) {
+    {
+        std::lock_guard guard(writerMutex_);
+        if(job.kind != WriteJob::Kind::Append)
+            std::erase_if(pendingJobs_, [&](const auto& j) { return j.path == job.path; }); // Superseded by the full file
+        else if(!pendingJobs_.empty() && pendingJobs_.back().kind == WriteJob::Kind::Append && pendingJobs_.back().path == job.path) {
+            pendingJobs_.back().text += job.text;
+            return;
         }
+        pendingJobs_.push_back(std::move(job));
+    }
+    writerCv_.notify_all();
+}
 
-        lastSaveErrorChanged_ |= prevSaveError != lastSaveError_;
+void INIConfigurationFile::CollectWriteResult() {
+    std::optional<std::string> result, written;
+    {
+        std::lock_guard guard(writerMutex_);
+        result = std::exchange(writeResult_, std::nullopt);
+        written = std::exchange(writtenContents_, std::nullopt);
     }
-    else if(!lastSaveError_.empty()) {
-        lastSaveError_.clear();
-        lastSaveErrorChanged_ = true;
+    if(result)
+        SaveError(std::move(*result));
+    if(written) {
+        diskContents_ = std::move(*written);
+        diskHash_ = Fnv1a(diskContents_);
+    }
+}
+
+void INIConfigurationFile::SaveError(std::string error) {
+    if(error == lastSaveError_)
+        return;
+
+    if(!error.empty())
+        LogErrorCat(Config, "Could not save configuration: {}", error);
+    lastSaveError_ = std::move(error);
+    lastSaveErrorChanged_ = true;
+}
+
+void INIConfigurationFile::WriterLoop(std::stop_token stop) {
+    std::unique_lock lock(writerMutex_);
+    while(writerCv_.wait(lock, stop, [&] { return !pendingJobs_.empty() && !writing_; }))
+        RunJobs(lock);
+}
+
+void INIConfigurationFile::RunJobs(std::unique_lock<std::mutex>& lock) {
+    auto jobs = std::exchange(pendingJobs_, {});
+    writing_ = true;
+    lock.unlock();
+
+    std::string error;
+    for(auto& job : jobs) {
+        if(auto e = RunJob(job); !e.empty())
+            error = std::move(e);
     }
+
+    lock.lock();
+    writing_ = false;
+    writeResult_ = std::move(error);
+    if(written_)
+        writtenContents_ = std::exchange(written_, std::nullopt);
+    writerCv_.notify_all();
+}
+
+std::string INIConfigurationFile::RunJob(WriteJob& job) {
+    const auto journal = JournalPath(job.path);
+
+    switch(job.kind) {
+    case WriteJob::Kind::Append: {
+        const bool fresh = journalSize_ == 0;
+        if(fresh)
+            job.text.insert(0, JournalHeader(journalBaseHash_));
+
+        ReplayJournal(journaled_, job.text);
+        journalSize_ += job.text.size();
+        // Once an append failed, the journal is missing changes and only rewriting the INI gets them to disk
+        if(!AppendToFile(journal, job.text, fresh).empty())
+            journalSize_ = std::max(journalSize_, JournalCompactSize);
+        if(journalSize_ < JournalCompactSize)
+            return {};
+
+        job.text.clear();
+        if(journaled_.Save(job.text, true) < 0)
+            return "Out of memory";
+        break;
+    }
+    case WriteJob::Kind::Compact:
+        journaled_.Reset();
+        journaled_.LoadData(job.text);
+        break;
+    case WriteJob::Kind::Rebase:
+        journaled_.Reset();
+        journaled_.LoadData(job.text);
+        journalBaseHash_ = job.baseHash;
+        journalSize_ = 0;
+        return {};
+    case WriteJob::Kind::Replace:
+        return WriteAtomically(job.path, job.text);
+    }
+
+    if(auto error = WriteAtomically(job.path, job.text); !error.empty())
+        return error;
+
+    // A journal which could not be removed no longer matches the hash and is ignored on load
+    journalBaseHash_ = Fnv1a(job.text);
+    journalSize_ = 0;
+    DeleteFileW(journal.c_str());
+    written_ = std::move(job.text);
+    return {};
 }
 
 void JSONConfigurationFile::Save() {
@@ -135,9 +1069,21 @@ void JSONConfigurationFile::Save() {
     if(!folder_ || readOnly_ || json_.empty())
         return;
 
-    std::ofstream cfg(*folder_ / ConfigFileName, std::ofstream::trunc | std::ofstream::out);
-    if(cfg.good())
-        cfg << std::setw(4) << json_ << std::endl;
+    std::stringstream ss;
+    ss << std::setw(4) << json_ << std::endl;
+    const auto str = ss.str();
+
+    // Binary, so the hash matches what is read back
+    const auto path = *folder_ / ConfigFileName;
+    std::ofstream cfg(path, std::ofstream::trunc | std::ofstream::out | std::ofstream::binary);
+    if(cfg.good()) {
+        cfg << str;
+        cfg.close();
+        // Our own write is not an external change
+        diskHash_ = Fnv1a(str);
+        if(!cfg.fail())
+            StoreJsonCache(path, json_);
+    }
     else {
         const auto prevSaveError = lastSaveError_;
         if(cfg.fail())
@@ -151,46 +1097,119 @@ void JSONConfigurationFile::Save() {
     }
 }
 
-void INIConfigurationFile::OnUpdate() const {
-    if(folder_)
-        SaveImGuiSettings(*folder_ / g_imguiConfigName);
-}
+void INIConfigurationFile::ApplyExternalChanges() {
+    if(!folder_)
+        return;
 
-void INIConfigurationFile::LoadImGuiSettings(const std::wstring& location) {
-    FILE* fp = nullptr;
-    if(_wfopen_s(&fp, location.c_str(), L"rt, ccs=UTF-8") != 0 || fp == nullptr)
+    const auto path = *folder_ / ConfigFileName;
+    std::string contents;
+    {
+        // Our own writes have to be accounted for before comparing, and none may start while reading
+        std::unique_lock lock(writerMutex_);
+        writerCv_.wait(lock, [&] { return !writing_; });
+        contents = ReadFileContents(path);
+    }
+    CollectWriteResult();
+
+    const u64 hash = Fnv1a(contents);
+    if(hash == diskHash_)
         return;
 
-    fseek(fp, 0, SEEK_END);
-    const auto num = ftell(fp);
+    // Only what changed in the file itself is applied, anything changed here since is kept
+    CSimpleIniA before, after;
+    before.SetUnicode();
+    after.SetUnicode();
+    before.LoadData(diskContents_);
+    after.LoadData(contents);
+    const auto changes = DiffIni(before, after);
 
-    std::wstring contents;
-    contents.resize(size_t(num) + 1);
+    diskContents_ = std::move(contents);
+    diskHash_ = hash;
+    LogInfoCat(Config, "config.ini was edited externally, {} values changed", changes.size());
 
-    fseek(fp, 0, SEEK_SET);
-    fread_s(contents.data(), contents.size() * sizeof(wchar_t), sizeof(wchar_t), num, fp);
-    fclose(fp);
+    std::vector<u32> changed;
+    for(const auto& c : changes) {
+        if(c.value)
+            ini_.SetValue(c.section.c_str(), c.key.c_str(), c.value->c_str());
+        else
+            ini_.Delete(c.section.c_str(), c.key.c_str());
+
+        const auto [section, character] = SplitProfileSection(c.section);
+        const auto it = entryIndices_.find(EntryName(section, c.key));
+        if(it == entryIndices_.end()) {
+            unclaimedStale_ = true;
+            continue;
+        }
 
-    auto utf8 = utf8_encode(contents);
-    ImGui::LoadIniSettingsFromMemory(utf8.c_str(), utf8.size());
+        auto& e = entries_[it->second];
+        // The external edit wins over a change still waiting to be saved
+        if(character.empty()) {
+            if(e.dirty) {
+                e.dirty = false;
+                std::erase(dirtyEntries_, it->second);
+            }
+            LoadEntry(e);
+        }
+        else {
+            const std::string name(character);
+            std::erase(dirtyOverrides_, std::pair(name, it->second));
+            auto& values = MutableLayer(name).values;
+            if(c.value)
+                values[it->second] = ParseValue(e.type, c.value->c_str());
+            else
+                values.erase(it->second);
+            if(name != profile_)
+                continue;
+        }
+        changed.push_back(it->second);
+    }
+
+    // The journal no longer applies to the file, write back anything only it held
+    if(!readOnly_) {
+        if(DiffIni(after, ini_).empty())
+            Queue({ WriteJob::Kind::Rebase, path, diskContents_, diskHash_ });
+        else if(auto merged = Serialize())
+            Queue({ WriteJob::Kind::Compact, path, std::move(*merged) });
+    }
+
+    RunChangeCallbacks(changed);
+}
+
+void INIConfigurationFile::OnUpdate() {
+    ConfigurationFile::OnUpdate();
+
+    if(folder_)
+        SaveImGuiSettings(*folder_ / g_imguiConfigName);
+
+    CollectWriteResult();
+    if(dirtySince_ && std::chrono::steady_clock::now() >= saveDeadline_)
+        QueueChanges();
 }
 
-void INIConfigurationFile::SaveImGuiSettings(const std::wstring& location) {
+void INIConfigurationFile::LoadImGuiSettings(const std::filesystem::path& location) {
+    auto contents = ReadFileContents(location);
+    // Older versions wrote it with a byte order mark
+    if(contents.starts_with("\xEF\xBB\xBF"))
+        contents.erase(0, 3);
+
+    imguiHash_ = Fnv1a(contents);
+    if(!contents.empty())
+        ImGui::LoadIniSettingsFromMemory(contents.data(), contents.size());
+}
+
+void INIConfigurationFile::SaveImGuiSettings(const std::filesystem::path& location) {
     auto& imio = ImGui::GetIO();
     if(!imio.WantSaveIniSettings)
         return;
-
-    FILE* fp = nullptr;
-    if(_wfopen_s(&fp, location.c_str(), L"wt, ccs=UTF-8") != 0 || fp == nullptr)
-        return;
+    imio.WantSaveIniSettings = false;
 
     size_t num;
-    const auto contentChar = ImGui::SaveIniSettingsToMemory(&num);
-    const std::string contents(contentChar, num);
-    const auto unicode = utf8_decode(contents);
-
-    fwrite(unicode.data(), sizeof(wchar_t), num, fp);
-    fclose(fp);
+    const char* contents = ImGui::SaveIniSettingsToMemory(&num);
+    const std::string_view text(contents, num);
+    const u64 hash = Fnv1a(text);
+    if(hash == imguiHash_)
+        return;
 
-    imio.WantSaveIniSettings = false;
+    imguiHash_ = hash;
+    Queue({ WriteJob::Kind::Replace, location, std::string(text) });
 }
@@ -24,14 +24,14 @@ std::pair<fs::path, fs::path> FileSystem::SplitZipPath(const fs::path& p, ZipArc
     }
     while(p2.has_relative_path() && !fs::exists(p2));
 
-    LogDebug(L"Looking for path '{}'; path '{}' is the closest existing parent", p.wstring(), p2.wstring());
+    LogDebugCat(FS, L"Looking for path '{}'; path '{}' is the closest existing parent", p.wstring(), p2.wstring());
 
     if(p2.has_extension() && p2.extension() == L".zip") {
         auto& fs = i();
 
         auto z = fs.FindOrCache(p2.string());
         if(z) {
-            LogDebug(L"Found and loaded zip file '{}'", p2.wstring());
+            LogDebugCat(FS, L"Found and loaded zip file '{}'", p2.wstring());
             if(zip)
                 *zip = z;
             return { p2, fs::relative(p, p2) };
@@ -60,7 +60,7 @@ bool FileSystem::Exists(const fs::path& p) {
 }
 
 std::vector<std::filesystem::path> FileSystem::IterateZipFolders(const std::filesystem::path& zipPath) {
-    LogDebug(L"Iterating files in archive '{}'", zipPath.wstring());
+    LogDebugCat(FS, L"Iterating files in archive '{}'", zipPath.wstring());
 
     auto& fs = i();
     ZipArchive* archive = fs.FindOrCache(zipPath);
@@ -75,7 +75,7 @@ std::vector<std::filesystem::path> FileSystem::IterateZipFolders(const std::file
 
         auto filepath = (zipPath / p.getName()).lexically_normal();
 
-        LogDebug(L"Found file '{}', mapping to '{}'", utf8_decode(p.getName()), filepath.wstring());
+        LogDebugCat(FS, L"Found file '{}', mapping to '{}'", utf8_decode(p.getName()), filepath.wstring());
 
         paths.push_back(filepath);
     }
@@ -123,7 +123,7 @@ std::filesystem::path FileSystem::GetSystemPath(const KNOWNFOLDERID& id, DWORD f
     SHGetKnownFolderPath(id, flags, nullptr, &path);
 
     std::filesystem::path p(path);
-    LogDebug(L"Mapped system path {} to '{}'", LogGUID<wchar_t>(id), p.wstring());
+    LogDebugCat(FS, L"Mapped system path {} to '{}'", LogGUID<wchar_t>(id), p.wstring());
     CoTaskMemFree(path);
     return p;
 }
@@ -0,0 +1,279 @@
+#include "FileWatcher.h"
+
+#include <algorithm>
+#include <array>
+#include <memory>
+
+#include "Utility.h"
+
+#ifndef _WIN32
+#include <poll.h>
+#include <sys/eventfd.h>
+#include <sys/inotify.h>
+#include <unistd.h>
+
+#include <unordered_map>
+#endif
+
+namespace
+{
+
+// File names compare case-insensitively on Windows only
+std::filesystem::path::string_type NormalizeName(std::filesystem::path::string_type name) {
+#ifdef _WIN32
+    return ToLower(name);
+#else
+    return name;
+#endif
+}
+
+}
+
+FileWatcher::FileWatcher() {
+#ifdef _WIN32
+    wakeEvent_ = CreateEventW(nullptr, FALSE, FALSE, nullptr);
+#else
+    wakeFd_ = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+#endif
+    thread_ = std::jthread([this](std::stop_token stop) { Run(stop); });
+}
+
+FileWatcher::~FileWatcher() {
+    thread_.request_stop();
+    Wake();
+    thread_.join();
+
+#ifdef _WIN32
+    CloseHandle(wakeEvent_);
+#else
+    close(wakeFd_);
+#endif
+}
+
+u32 FileWatcher::Watch(const std::filesystem::path& file, Callback callback) {
+    const auto absolute = std::filesystem::absolute(file);
+
+    std::lock_guard guard(mutex_);
+    const u32 id = nextId_++;
+    files_.push_back({ id, absolute.parent_path(), NormalizeName(absolute.filename().native()), std::move(callback) });
+    directoriesChanged_ = true;
+    Wake();
+
+    LogDebugCat(FS, L"Watching '{}' for changes", absolute.wstring());
+    return id;
+}
+
+void FileWatcher::Unwatch(u32 id) {
+    std::lock_guard guard(mutex_);
+    if(std::erase_if(files_, [id](const auto& f) { return f.id == id; }) > 0) {
+        directoriesChanged_ = true;
+        Wake();
+    }
+}
+
+void FileWatcher::Wake() {
+#ifdef _WIN32
+    SetEvent(wakeEvent_);
+#else
+    const u64 one = 1;
+    [[maybe_unused]] const auto r = write(wakeFd_, &one, sizeof(one));
+#endif
+}
+
+std::vector<std::filesystem::path> FileWatcher::directories() {
+    std::lock_guard guard(mutex_);
+    directoriesChanged_ = false;
+
+    std::vector<std::filesystem::path> dirs;
+    for(const auto& f : files_) {
+        if(std::ranges::find(dirs, f.directory) == dirs.end())
+            dirs.push_back(f.directory);
+    }
+    return dirs;
+}
+
+void FileWatcher::Notify(const std::filesystem::path& directory, std::filesystem::path::string_type name) {
+    name = NormalizeName(std::move(name));
+
+    std::lock_guard guard(mutex_);
+    for(const auto& f : files_) {
+        if(f.name == name && f.directory == directory)
+            f.callback(f.directory / f.name);
+    }
+}
+
+#ifdef _WIN32
+
+void FileWatcher::Run(std::stop_token stop) {
+    struct Directory
+    {
+        std::filesystem::path path;
+        HANDLE handle = INVALID_HANDLE_VALUE;
+        OVERLAPPED overlapped {};
+        alignas(DWORD) std::array<std::byte, 16 * 1024> buffer;
+
+        ~Directory() {
+            if(handle != INVALID_HANDLE_VALUE) {
+                CancelIoEx(handle, &overlapped);
+                DWORD bytes;
+                GetOverlappedResult(handle, &overlapped, &bytes, TRUE);
+                CloseHandle(handle);
+            }
+            if(overlapped.hEvent)
+                CloseHandle(overlapped.hEvent);
+        }
+
+        bool Listen() {
+            return ReadDirectoryChangesW(handle, buffer.data(), DWORD(buffer.size()), FALSE,
+                                         FILE_NOTIFY_CHANGE_FILE_NAME | FILE_NOTIFY_CHANGE_LAST_WRITE | FILE_NOTIFY_CHANGE_SIZE,
+                                         nullptr, &overlapped, nullptr);
+        }
+    };
+
+    std::vector<std::unique_ptr<Directory>> dirs;
+    std::vector<HANDLE> events;
+
+    while(!stop.stop_requested()) {
+        bool changed;
+        {
+            std::lock_guard guard(mutex_);
+            changed = directoriesChanged_;
+        }
+
+        if(changed) {
+            const auto paths = directories();
+            std::erase_if(dirs, [&](const auto& d) { return std::ranges::find(paths, d->path) == paths.end(); });
+
+            for(const auto& path : paths) {
+                if(std::ranges::any_of(dirs, [&](const auto& d) { return d->path == path; }))
+                    continue;
+
+                auto dir = std::make_unique<Directory>();
+                dir->path = path;
+                dir->handle = CreateFileW(path.c_str(), FILE_LIST_DIRECTORY, FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE, nullptr,
+                                          OPEN_EXISTING, FILE_FLAG_BACKUP_SEMANTICS | FILE_FLAG_OVERLAPPED, nullptr);
+                dir->overlapped.hEvent = CreateEventW(nullptr, TRUE, FALSE, nullptr);
+                if(dir->handle == INVALID_HANDLE_VALUE || !dir->overlapped.hEvent || !dir->Listen()) {
+                    LogWarnCat(FS, L"Could not watch folder '{}' for changes", path.wstring());
+                    continue;
+                }
+                dirs.push_back(std::move(dir));
+            }
+
+            events.assign(1, wakeEvent_);
+            for(const auto& d : dirs)
+                events.push_back(d->overlapped.hEvent);
+        }
+
+        const DWORD r = WaitForMultipleObjects(DWORD(events.size()), events.data(), FALSE, INFINITE);
+        if(r == WAIT_OBJECT_0)
+            continue;
+        if(r >= WAIT_OBJECT_0 + events.size())
+            break;
+
+        const size_t index = r - WAIT_OBJECT_0 - 1;
+        auto& dir = *dirs[index];
+        DWORD bytes = 0;
+        const bool ok = GetOverlappedResult(dir.handle, &dir.overlapped, &bytes, FALSE);
+
+        std::vector<std::wstring> names;
+        if(ok && bytes > 0) {
+            for(size_t offset = 0;;) {
+                const auto* info = reinterpret_cast<const FILE_NOTIFY_INFORMATION*>(dir.buffer.data() + offset);
+                if(info->Action != FILE_ACTION_REMOVED && info->Action != FILE_ACTION_RENAMED_OLD_NAME) {
+                    std::wstring name(info->FileName, info->FileNameLength / sizeof(wchar_t));
+                    if(std::ranges::find(names, name) == names.end())
+                        names.push_back(std::move(name));
+                }
+                if(info->NextEntryOffset == 0)
+                    break;
+                offset += info->NextEntryOffset;
+            }
+        }
+        else if(ok) {
+            // The buffer overflowed and the changes were lost, so anything in the folder may have changed
+            std::lock_guard guard(mutex_);
+            for(const auto& f : files_) {
+                if(f.directory == dir.path)
+                    names.push_back(f.name);
+            }
+        }
+
+        const auto path = dir.path;
+        if(!dir.Listen()) {
+            // Its event would stay signaled
+            LogWarnCat(FS, L"Stopped watching folder '{}' for changes", path.wstring());
+            dirs.erase(dirs.begin() + index);
+            events.erase(events.begin() + index + 1);
+        }
+
+        for(auto& name : names)
+            Notify(path, std::move(name));
+    }
+}
+
+#else
+
+void FileWatcher::Run(std::stop_token stop) {
+    const int fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if(fd < 0) {
+        LogWarnCat(FS, "Could not initialize inotify, file changes will not be detected");
+        return;
+    }
+
+    std::unordered_map<int, std::filesystem::path> watches;
+    alignas(inotify_event) std::array<char, 16 * 1024> buffer;
+
+    while(!stop.stop_requested()) {
+        bool changed;
+        {
+            std::lock_guard guard(mutex_);
+            changed = directoriesChanged_;
+        }
+
+        if(changed) {
+            const auto paths = directories();
+            std::erase_if(watches, [&](const auto& w) {
+                if(std::ranges::find(paths, w.second) != paths.end())
+                    return false;
+                inotify_rm_watch(fd, w.first);
+                return true;
+            });
+
+            for(const auto& path : paths) {
+                if(std::ranges::any_of(watches, [&](const auto& w) { return w.second == path; }))
+                    continue;
+
+                const int wd = inotify_add_watch(fd, path.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO | IN_CREATE);
+                if(wd < 0)
+                    LogWarnCat(FS, "Could not watch folder '{}' for changes", path.string());
+                else
+                    watches.emplace(wd, path);
+            }
+        }
+
+        std::array<pollfd, 2> fds { pollfd { wakeFd_, POLLIN, 0 }, pollfd { fd, POLLIN, 0 } };
+        if(poll(fds.data(), fds.size(), -1) < 0)
+            continue;
+
+        if(fds[0].revents & POLLIN) {
+            u64 count;
+            [[maybe_unused]] const auto r = read(wakeFd_, &count, sizeof(count));
+        }
+
+        if(fds[1].revents & POLLIN) {
+            for(ssize_t len; (len = read(fd, buffer.data(), buffer.size())) > 0;) {
+                for(ssize_t offset = 0; offset < len;) {
+                    const auto* event = reinterpret_cast<const inotify_event*>(buffer.data() + offset);
+                    if(const auto it = watches.find(event->wd); it != watches.end() && event->len > 0)
+                        Notify(it->second, event->name);
+                    offset += sizeof(inotify_event) + event->len;
+                }
+            }
+        }
+    }
+
+    close(fd);
+}
+
+#endif
@@ -269,7 +269,7 @@ void RenderDocCapture::Init(ComPtr<ID3D11Device>& dev) {
 RenderDocCapture::RenderDocCapture() {
     if(!rdoc_)
         return;
-    LogDebug("Beginning RenderDoc frame capture...");
+    LogDebugCat(Graphics, "Beginning RenderDoc frame capture...");
 
     rdoc_->StartFrameCapture(dev_.Get(), nullptr);
 }
@@ -277,7 +277,7 @@ RenderDocCapture::RenderDocCapture() {
 RenderDocCapture::~RenderDocCapture() {
     if(!rdoc_)
         return;
-    LogDebug("Ending RenderDoc frame capture...");
+    LogDebugCat(Graphics, "Ending RenderDoc frame capture...");
 
     rdoc_->EndFrameCapture(dev_.Get(), nullptr);
 }
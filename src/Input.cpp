@@ -50,7 +50,8 @@ bool Input::OnInput(UINT& msg, WPARAM& wParam, LPARAM& lParam) {
         bool eventDown = false;
         switch(msg) {
         case WM_INPUTLANGCHANGE:
-            inputLanguageChangeEvent_();
+            // Layout changes tend to arrive in bursts, only react once per frame
+            GetBaseCore().deferredEvents().PostCoalesced(inputLanguageChangeEvent_);
             break;
         case WM_SYSKEYDOWN:
         case WM_KEYDOWN:
@@ -279,8 +280,8 @@ void Input::KeyUpActive() {
 void Input::ClearActive() {
     downModifiers_ = Modifier::None;
     activeKeybind_ = nullptr;
-    LogInfo("Clearing active keybind {} and modifiers {}", activeKeybind_ ? activeKeybind_->nickname().c_str() : "null",
-            ToUnderlying(downModifiers_));
+    LogInfoCat(Input, "Clearing active keybind {} and modifiers {}", activeKeybind_ ? activeKeybind_->nickname().c_str() : "null",
+               ToUnderlying(downModifiers_));
 }
 
 void Input::BlockKeybinds(u32 id) {
@@ -290,7 +291,7 @@ void Input::BlockKeybinds(u32 id) {
         return;
 
     ClearActive();
-    LogInfo("Blocking keybinds, flag {} -> {}", old, blockKeybinds_);
+    LogInfoCat(Input, "Blocking keybinds, flag {} -> {}", old, blockKeybinds_);
 }
 
 void Input::UnblockKeybinds(u32 id) {
@@ -299,14 +300,11 @@ void Input::UnblockKeybinds(u32 id) {
     if(old == blockKeybinds_)
         return;
 
-    LogInfo("Unblocking keybinds, flag {} -> {}", old, blockKeybinds_);
+    LogInfoCat(Input, "Unblocking keybinds, flag {} -> {}", old, blockKeybinds_);
 }
 
 PassToGame Input::TriggerKeybinds(const EventKey& ek) {
-#ifdef _DEBUG
-    auto dbgKeys = EventKeyToString(ek, downModifiers_);
-    Log::i().Print(Severity::Debug, L"Triggering keybinds, active keys: {}", dbgKeys);
-#endif
+    LogDebugCat(Input, L"Triggering keybinds, active keys: {}", EventKeyToString(ek, downModifiers_));
 
     // Key is pressed  => use it as main key
     // Key is released => if it's a modifier, keep last down key as main key
@@ -322,7 +320,7 @@ PassToGame Input::TriggerKeybinds(const EventKey& ek) {
     bool activeKeybindDeactivated =
         activeKeybind_ && !ek.down && (ek.sc == activeKeybind_->key() || NotNone(ToModifier(ek.sc) & activeKeybind_->modifier()));
     if(activeKeybind_ && !activeKeybindDeactivated) {
-        LogInfo("Best candidate keybind set to prior active keybind '{}'", activeKeybind_->nickname());
+        LogInfoCat(Input, "Best candidate keybind set to prior active keybind '{}'", activeKeybind_->nickname());
         bestKeybind = { .condiScore = activeKeybind_->conditionsScore(), .keyScore = activeKeybind_->keysScore(), .kb = activeKeybind_ };
     }
 
@@ -341,9 +339,7 @@ PassToGame Input::TriggerKeybinds(const EventKey& ek) {
                 std::ignore = activeKeybind_->callback()(Activated::No);
             activeKeybind_ = bestKeybind.kb;
 
-#ifdef _DEBUG
-            LogInfo("Active keybind is now '{}'", activeKeybind_->nickname());
-#endif
+            LogDebugCat(Input, "Active keybind is now '{}'", activeKeybind_->nickname());
 
             return activeKeybind_->callback()(Activated::Yes);
         }
@@ -351,9 +347,7 @@ PassToGame Input::TriggerKeybinds(const EventKey& ek) {
     else if(activeKeybindDeactivated) {
         std::ignore    = activeKeybind_->callback()(Activated::No);
         activeKeybind_ = nullptr;
-#ifdef _DEBUG
-        LogInfo("Active keybind is now null");
-#endif
+        LogDebugCat(Input, "Active keybind is now null");
     }
 
     return PassToGame::Allow;
@@ -530,22 +524,20 @@ void Input::SendQueuedInputs() {
     // Only send inputs that aren't too old
     if(currentTime < qi.t + 1000 && (!MumbleLink::i().textboxHasFocus() || qi.ignoreChat)) {
         if(qi.cursorPos) {
-            Log::i().Print(Severity::Debug, L"Moving cursor to ({}, {})...", qi.cursorPos->x, qi.cursorPos->y);
+            LogDebugCat(Input, L"Moving cursor to ({}, {})...", qi.cursorPos->x, qi.cursorPos->y);
             POINT p { qi.cursorPos->x, qi.cursorPos->y };
             ClientToScreen(GetBaseCore().gameWindow(), &p);
             SetCursorPos(p.x, p.y);
         }
 
         if(qi.msg != id_H_MOUSEMOVE_) {
-#ifdef _DEBUG
             if(qi.msg == WM_CHAR)
-                Log::i().Print(Severity::Debug, L"Sending char 0x{:x} ({})...", u32(qi.wParam), char(qi.wParam));
-            else {
+                LogDebugCat(Input, L"Sending char 0x{:x} ({})...", u32(qi.wParam), char(qi.wParam));
+            else if(Log::enabled(Severity::Debug, LogCategory::Input)) {
                 wchar_t keyNameBuf[128];
                 GetKeyNameTextW(LONG(qi.lParamValue), keyNameBuf, sizeof(keyNameBuf));
-                Log::i().Print(Severity::Debug, L"Sending keybind 0x{:x} ({})...", u32(qi.wParam), keyNameBuf);
+                LogDebugCat(Input, L"Sending keybind 0x{:x} ({})...", u32(qi.wParam), keyNameBuf);
             }
-#endif
             PostMessage(GetBaseCore().gameWindow(), qi.msg, qi.wParam, qi.lParamValue);
         }
     }
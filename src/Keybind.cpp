@@ -5,35 +5,16 @@
 #include "ConfigurationFile.h"
 #include "Utility.h"
 
-Keybind::Keybind(std::string_view nickname, std::string_view displayName, std::string_view category, ScanCode key, Modifier mod, bool saveToConfig)
-    : nickname_(nickname), displayName_(displayName), category_(category), saveToConfig_(saveToConfig) {
-    keyCombo({ key, mod });
-    languageChangeCallbackID_ = GetBaseCore().languageChangeEvent().AddCallback([this]() { UpdateDisplayString(); });
-}
+namespace
+{
 
-Keybind::Keybind(std::string_view nickname, std::string_view displayName, std::string_view category)
-    : nickname_(nickname), displayName_(displayName), category_(category) {
-    if(auto keys = INIConfigurationFile::i().ini().GetValue("Keybinds.2", nickname_.c_str())) {
-        ParseConfig(keys);
-    } else {
-        keys = INIConfigurationFile::i().ini().GetValue("Keybinds", nickname_.c_str());
-        if(keys)
-            ParseKeys(keys);
-        else
-            keyCombo({ ScanCode::None, Modifier::None });
-    }
-    languageChangeCallbackID_ = GetBaseCore().languageChangeEvent().AddCallback([this]() { UpdateDisplayString(); });
-}
-
-Keybind::~Keybind() { GetBaseCore().languageChangeEvent().RemoveCallback(std::move(languageChangeCallbackID_)); }
-
-void Keybind::ParseKeys(const char* keys) {
-    key_ = ScanCode::None;
-    mod_ = Modifier::None;
+// Older versions stored keybinds as comma-separated virtual key codes
+KeyCombo ParseVirtualKeys(const char* keys) {
+    ScanCode key = ScanCode::None;
+    Modifier mod = Modifier::None;
 
     if(strnlen_s(keys, 256) > 0) {
         std::stringstream ss(keys);
-        std::vector<std::string> result;
 
         while(ss.good()) {
             std::string substr;
@@ -44,20 +25,71 @@ void Keybind::ParseKeys(const char* keys) {
             ScanCode code = ScanCode(u32(val));
 
             if(IsModifier(code)) {
-                if(key_ != ScanCode::None)
-                    mod_ = mod_ | ToModifier(code);
+                if(key != ScanCode::None)
+                    mod = mod | ToModifier(code);
                 else
-                    key_ = code;
+                    key = code;
             }
             else {
-                if(IsModifier(key_))
-                    mod_ = mod_ | ToModifier(key_);
+                if(IsModifier(key))
+                    mod = mod | ToModifier(key);
 
-                key_ = code;
+                key = code;
             }
         }
     }
 
+    return { key, mod };
+}
+
+std::string FormatConfig(const KeyCombo& kc) {
+    return std::to_string(u32(kc.key())) + ", " + std::to_string(u32(kc.mod()));
+}
+
+// Moves the legacy Keybinds section into Keybinds.2, which holds scan codes and modifiers
+const bool g_keybindsMigration = INIConfigurationFile::RegisterMigration({ "Keybinds", 1, [](CSimpleIniA& ini) {
+    CSimpleIniA::TNamesDepend keys;
+    ini.GetAllKeys("Keybinds", keys);
+    for(const auto& key : keys) {
+        if(ini.GetValue("Keybinds.2", key.pItem))
+            continue;
+
+        try {
+            const auto kc = ParseVirtualKeys(ini.GetValue("Keybinds", key.pItem, ""));
+            if(kc.key() != ScanCode::None)
+                ini.SetValue("Keybinds.2", key.pItem, FormatConfig(kc).c_str());
+        }
+        catch(const std::exception&) {
+            LogWarnCat(Config, "Dropping malformed legacy keybind '{}'", key.pItem);
+        }
+    }
+    ini.Delete("Keybinds", nullptr);
+} });
+
+}
+
+Keybind::Keybind(std::string_view nickname, std::string_view displayName, std::string_view category, ScanCode key, Modifier mod, bool saveToConfig)
+    : nickname_(nickname), displayName_(displayName), category_(category), saveToConfig_(saveToConfig) {
+    keyCombo({ key, mod });
+    GetBaseCore().keybindLanguageChangeEvent().Add(languageChangeHook_);
+}
+
+Keybind::Keybind(std::string_view nickname, std::string_view displayName, std::string_view category)
+    : nickname_(nickname), displayName_(displayName), category_(category) {
+    auto& cfg = INIConfigurationFile::i();
+    configKey_ = cfg.Resolve("Keybinds.2", nickname_);
+    if(auto keys = cfg.GetString(configKey_, nullptr))
+        ParseConfig(keys);
+    else
+        keyCombo({ ScanCode::None, Modifier::None });
+    GetBaseCore().keybindLanguageChangeEvent().Add(languageChangeHook_);
+}
+
+void Keybind::ParseKeys(const char* keys) {
+    const auto kc = ParseVirtualKeys(keys);
+    key_ = kc.key();
+    mod_ = kc.mod();
+
     ApplyKeys();
 }
 
@@ -82,13 +114,13 @@ void Keybind::ApplyKeys() {
     UpdateDisplayString();
 
     if(saveToConfig_) {
-        std::string settingValue = std::to_string(u32(key_)) + ", " + std::to_string(u32(mod_));
-
         auto& cfg = INIConfigurationFile::i();
+        if(!configKey_.valid())
+            configKey_ = cfg.Resolve("Keybinds.2", nickname_);
         if(key_ != ScanCode::None)
-            cfg.ini().SetValue("Keybinds.2", nickname_.c_str(), settingValue.c_str());
+            cfg.SetString(configKey_, FormatConfig({ key_, mod_ }));
         else
-            cfg.ini().DeleteValue("Keybinds.2", nickname_.c_str(), nullptr);
+            cfg.Erase(configKey_);
         cfg.Save();
     }
 }
@@ -115,7 +147,7 @@ void Keybind::UpdateDisplayString(std::optional<KeyCombo> kc) const {
 
     keybind += GetScanCodeName(k.key());
 
-    Log::i().Print(Severity::Debug, L"Setting keybind '{}' to display '{}'", utf8_decode(nickname()), keybind);
+    LogDebugCat(Input, L"Setting keybind '{}' to display '{}'", utf8_decode(nickname()), keybind);
 
     strcpy_s(keysDisplayString_.data(), keysDisplayString_.size(), utf8_encode(keybind).c_str());
 }
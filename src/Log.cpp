@@ -1,17 +1,75 @@
 #include "Log.h"
 
+#include "BinaryLogFile.h"
 #include "ImGuiExtensions.h"
+#include "LogSink.h"
+#include "MappedLogRing.h"
 #include "Utility.h"
 
 extern std::ofstream g_logStream;
 
+// Feeds the log window, which keeps every line regardless of severity so its filters can be changed after the fact
+class Log::WindowSink : public LogSink
+{
+public:
+    explicit WindowSink(Log& log) : LogSink(u8(Severity::MaxVal)), log_(log) { }
+
+    void Write(const LogBatch& batch) override {
+        std::lock_guard guard { log_.linesMutex_ };
+        batch.ForEach([&](const LogEntry& e) {
+            for(size_t start = 0;;) {
+                const size_t end = e.message.find('\n', start);
+                log_.lines_.Push(e.time, e.sev, e.message.substr(start, end - start));
+                if(end == std::string_view::npos)
+                    break;
+                start = end + 1;
+            }
+        });
+    }
+
+private:
+    Log& log_;
+};
+
 Log::Log() {
 #ifdef _DEBUG
     isVisible_ = IsDebuggerPresent();
 #endif
+
+    sinks_.push_back(std::make_unique<DebuggerLogSink>(u8(Severity::MaxVal)));
+    sinks_.push_back(std::make_unique<WindowSink>(*this));
+    fileSink_ = sinks_.emplace_back(std::make_unique<TextFileLogSink>(logStream(), u8(Severity::MaxVal))).get();
+
+    writer_ = std::jthread([this](std::stop_token stop) { WriterLoop(std::move(stop)); });
 }
 
-Log::~Log() { logStream().flush(); }
+void LogCallSite::Suppress() {
+    suppressed_.fetch_add(1, std::memory_order_relaxed);
+    if(registered_.exchange(true, std::memory_order_relaxed))
+        return;
+
+    next_ = suppressedSites_.load(std::memory_order_relaxed);
+    while(!suppressedSites_.compare_exchange_weak(next_, this, std::memory_order_release, std::memory_order_relaxed)) { }
+}
+
+Log::~Log() {
+    writer_.request_stop();
+    Wake();
+    writer_.join();
+
+    logStream().flush();
+}
+
+void Log::Flush(std::chrono::milliseconds timeout) {
+    const u64 target = recordsQueued_.load(std::memory_order_acquire);
+    const auto deadline = std::chrono::steady_clock::now() + timeout;
+    flushRequested_ = true;
+    Wake();
+    while((recordsWritten_.load(std::memory_order_acquire) < target || flushRequested_) && std::chrono::steady_clock::now() < deadline) {
+        Wake();
+        std::this_thread::yield();
+    }
+}
 
 void Log::Draw() {
     if(!isVisible_)
@@ -25,7 +83,7 @@ void Log::Draw() {
 
     if(ImGui::Button("Clear")) {
         std::lock_guard guard { linesMutex_ };
-        lines_.clear();
+        lines_.Clear();
     }
     ImGui::SameLine();
 
@@ -50,49 +108,64 @@ void Log::Draw() {
         }
         ImGui::PopStyleColor();
     };
-#ifdef _DEBUG
     filter("Debug", Severity::Debug);
-#endif
     filter("Info", Severity::Info);
     filter("Warn", Severity::Warn);
     filter("Error", Severity::Error);
 
+    ImGui::SameLine();
+    if(ImGui::Button("Categories..."))
+        ImGui::OpenPopup("Categories");
+    if(ImGui::BeginPopup("Categories")) {
+        // Messages below the minimum severity of their category are discarded before being formatted
+        constexpr std::array severities { "Debug", "Info", "Warn", "Error", "Off" };
+        for(u32 i = 0; i < EnumSize<LogCategory>(); i++) {
+            const auto cat = LogCategory(i);
+            const u8 mask = enabledSeverities(cat);
+            i32 minimum = mask == 0 ? i32(severities.size()) - 1 : std::countr_zero(mask);
+
+            ImGui::SetNextItemWidth(ImGui::GetFontSize() * 6.f);
+            if(ImGui::Combo(ToString(cat), &minimum, severities.data(), i32(severities.size())))
+                enabledSeverities(cat, u8((u8(Severity::MaxVal) << minimum) & u8(Severity::MaxVal)));
+        }
+        ImGui::EndPopup();
+    }
+
+    ImGui::SetNextItemWidth(ImGui::GetFontSize() * 20.f);
+    ImGui::InputTextWithHint("##Search", "Search...", searchText_.data(), searchText_.size());
+    ImGui::SameLine();
+    ImGui::Checkbox("Regex", &searchRegex_);
+    search_.Query(searchText_.data(), searchRegex_ ? LogSearch::Mode::Regex : LogSearch::Mode::Substring, filter_);
+    if(!search_.valid()) {
+        ImGui::SameLine();
+        ImGui::TextColored(ImColor(ToColor(Severity::Error)), "Invalid regex");
+    }
+
     ImGui::Separator();
     ImGui::BeginChild("logScroll", ImVec2(0, 0), false, ImGuiWindowFlags_AlwaysHorizontalScrollbar | ImGuiWindowFlags_AlwaysVerticalScrollbar);
     ImGui::PushStyleVar(ImGuiStyleVar_ItemSpacing, ImVec2(0, 0));
     ImGui::PushFont(GetBaseCore().fontMono());
 
+    std::unique_lock guard { linesMutex_ };
+    search_.Update(lines_);
     if(!lines_.empty()) {
-        std::lock_guard guard { linesMutex_ };
-        i32 filtered_size = i32(lines_.size());
-        if((filter_ & uint8_t(Severity::MaxVal)) != uint8_t(Severity::MaxVal)) {
-            for(const auto& l : lines_)
-                if((uint8_t(l.sev) & filter_) == 0)
-                    filtered_size--;
-        }
-
+        const i32 filtered_size = i32(search_.active() ? search_.size() : lines_.filteredSize(filter_));
         if(filtered_size > 0) {
             ImGuiListClipper clipper;
             clipper.Begin(filtered_size);
             while(clipper.Step()) {
-                i32 offset = 0;
-                for(i32 line_no = 0; line_no < clipper.DisplayEnd;) {
-                    const auto& l = lines_[line_no + offset];
-                    if((uint8_t(l.sev) & filter_) == 0) {
-                        offset++;
-                        continue;
-                    }
-
-                    line_no++;
-                    if(clipper.DisplayStart >= line_no)
-                        continue;
+                for(i32 line_no = clipper.DisplayStart + 1; line_no <= clipper.DisplayEnd; line_no++) {
+                    const size_t row = size_t(line_no - 1);
+                    const auto& l = search_.active() ? lines_.bySequence(search_[row]) : lines_.filtered(filter_, row);
 
                     uint32_t col = (line_no & 1) == 0 ? 0xFFFFFFFF : 0xFFDDDDDD;
 
                     ImGui::PushID(line_no);
 
                     ImGui::PushStyleColor(ImGuiCol_Text, col);
-                    ImGui::TextUnformatted(l.time.c_str());
+                    char timeBuffer[32];
+                    const auto time = ToString(Timestamp(Timestamp::duration(l.time)), timeBuffer);
+                    ImGui::TextUnformatted(time.data(), time.data() + time.size());
                     ImGui::SameLine();
 
                     ImGui::PushStyleColor(ImGuiCol_Text, ToColor(l.sev));
@@ -100,7 +173,8 @@ void Log::Draw() {
                     ImGui::SameLine();
 
                     ImGui::PushStyleColor(ImGuiCol_Text, col);
-                    ImGui::TextUnformatted(l.message.c_str());
+                    const auto message = lines_.text(l);
+                    ImGui::TextUnformatted(message.data(), message.data() + message.size());
 
                     ImGui::PopStyleColor(3);
                     ImGui::PopID();
@@ -109,6 +183,7 @@ void Log::Draw() {
             clipper.End();
         }
     }
+    guard.unlock();
 
     ImGui::PopFont();
     ImGui::PopStyleVar();
@@ -120,28 +195,287 @@ void Log::Draw() {
     ImGui::End();
 }
 
-void Log::PrintInternal(Severity sev, const std::string& line) {
-    std::lock_guard guard { linesMutex_ };
+void Log::Print(Severity sev, LogCategory cat, std::string_view message) {
+    if(!enabled(sev, cat))
+        return;
+
+    PrintInternal(sev, cat, message);
+}
+
+void Log::Print(Severity sev, LogCategory cat, std::wstring_view message) {
+    if(!enabled(sev, cat))
+        return;
+
+    std::string line;
+    AppendUtf8(line, message);
+    PrintInternal(sev, cat, line);
+}
+
+void Log::enabledSeverities(LogCategory cat, u8 mask) {
+    const u32 shift = LogDetail::CategoryShift(cat);
+    const u64 nibble = u64(Severity::MaxVal) << shift;
+    u64 bits = enabledSeverities_.load(std::memory_order_relaxed);
+    u64 desired;
+    do {
+        desired = (bits & ~nibble) | ((u64(mask) << shift) & nibble);
+    } while(!enabledSeverities_.compare_exchange_weak(bits, desired, std::memory_order_relaxed));
+}
 
-    {
-        auto ts = ToString(Timestamp::clock::now());
-        std::list<std::string> lines;
-        SplitString(line.c_str(), "\n", std::back_inserter(lines));
-        for(auto& l : lines)
-            lines_.push_back({ sev, ts, l });
+void Log::AppendUtf8(std::string& out, std::wstring_view s) {
+    out += utf8_encode(std::wstring(s));
+}
+
+void Log::PrintInternal(Severity sev, LogCategory cat, std::string_view line) {
+    Record r;
+    if(line.size() <= Record::InlineSize) {
+        r.size = u16(line.size());
+        memcpy(r.text.data(), line.data(), line.size());
+    }
+    else if(ReserveOverflow(line.size())) {
+        r.size = 0;
+        r.overflow = line;
+    }
+    else {
+        // Out of budget, keep what fits inline rather than growing without bound
+        truncatedRecords_.fetch_add(1, std::memory_order_relaxed);
+        // Cut at a code point boundary, a partial UTF-8 sequence would reach every sink as invalid text
+        size_t size = Record::InlineSize;
+        while(size > 0 && (u8(line[size]) & 0xC0) == 0x80)
+            size--;
+        r.size = u16(size);
+        memcpy(r.text.data(), line.data(), size);
     }
 
-    while(lines_.size() > maxLines_)
-        lines_.pop_front();
+    Push(sev, cat, std::move(r));
+}
+
+bool Log::ReserveOverflow(size_t size) {
+    if(overflowBytes_.fetch_add(size, std::memory_order_relaxed) + size <= OverflowBudget)
+        return true;
 
-    std::string l = std::format("{}{}{}\n", lines_.back().time, ToString(sev), line);
-    OutputDebugStringA(l.c_str());
-    logStream() << l.c_str();
+    overflowBytes_.fetch_sub(size, std::memory_order_relaxed);
+    return false;
 }
 
-std::string Log::ToString(const std::string& s) { return s; }
+void Log::Push(Severity sev, LogCategory cat, Record&& r) {
+    r.time = Timestamp::clock::now().time_since_epoch().count();
+    r.sev = sev;
+    r.cat = cat;
 
-std::string Log::ToString(const std::wstring& s) { return utf8_encode(s); }
+    if(!records_.try_push(std::move(r))) {
+        droppedRecords_.fetch_add(1, std::memory_order_relaxed);
+        // The writer never sees this record, so give its spilled text back to the budget here
+        overflowBytes_.fetch_sub(r.overflow.size(), std::memory_order_relaxed);
+        return;
+    }
+
+    recordsQueued_.fetch_add(1, std::memory_order_release);
+    Wake();
+}
+
+void Log::Wake() {
+    // Only the first producer after the writer went idle pays for the wake-up
+    if(!recordsPending_.exchange(true, std::memory_order_acq_rel))
+        wakeup_.release();
+}
+
+void Log::WriterLoop(std::stop_token stop) {
+    while(!stop.stop_requested()) {
+        // Wake up for sink batches falling due, and periodically while there may be repeats or suppressed messages
+        // left to report. On timeout the pending flag is left alone: if it is set, the matching release is already on
+        // its way.
+        auto wakeUp = nextDelivery_;
+        if(repeats_ > 0 || LogCallSite::suppressedSites_.load(std::memory_order_relaxed))
+            wakeUp = std::min(wakeUp, nextSummary_);
+
+        bool woken = true;
+        if(wakeUp != std::chrono::steady_clock::time_point::max())
+            woken = wakeup_.try_acquire_until(wakeUp);
+        else
+            wakeup_.acquire();
+
+        if(woken)
+            recordsPending_.store(false, std::memory_order_release);
+        WriteBatch(false);
+    }
+
+    WriteBatch(true);
+}
+
+void Log::WriteBatch(bool final) {
+    u64 written = 0;
+    std::lock_guard guard { sinksMutex_ };
+
+    Record r;
+    while(records_.try_pop(r)) {
+        if(r.formatter) {
+            formatted_.clear();
+            try {
+                r.formatter->format(formatted_, r.fmt, r.fmtSize, r.data().data());
+            }
+            catch(const std::format_error& e) {
+                formatted_ = std::format("<format error: {}>", e.what());
+            }
+            WriteMessage(r.sev, r.cat, r.time, formatted_, &r);
+        }
+        else
+            WriteMessage(r.sev, r.cat, r.time, r.data(), nullptr);
+
+        if(!r.overflow.empty()) {
+            overflowBytes_.fetch_sub(r.overflow.size(), std::memory_order_relaxed);
+            r.overflow = {};
+        }
+        written++;
+    }
+
+    if(const u64 dropped = droppedRecords_.load(std::memory_order_relaxed); dropped != reportedDroppedRecords_) {
+        Emit(Severity::Warn, LogCategory::General, Timestamp::clock::now().time_since_epoch().count(),
+             std::format("Log queue overflow, {} records dropped", dropped - reportedDroppedRecords_));
+        reportedDroppedRecords_ = dropped;
+    }
+    if(const u64 truncated = truncatedRecords_.load(std::memory_order_relaxed); truncated != reportedTruncatedRecords_) {
+        Emit(Severity::Warn, LogCategory::General, Timestamp::clock::now().time_since_epoch().count(),
+             std::format("Log memory budget exceeded, {} records truncated", truncated - reportedTruncatedRecords_));
+        reportedTruncatedRecords_ = truncated;
+    }
+
+    const bool flush = final || flushRequested_;
+    if(flush || std::chrono::steady_clock::now() >= nextSummary_) {
+        WriteSummaries();
+        nextSummary_ = std::chrono::steady_clock::now() + SummaryInterval;
+    }
+
+    nextDelivery_ = DeliverSinks(flush);
+    flushRequested_ = false;
+
+    recordsWritten_.fetch_add(written, std::memory_order_release);
+}
+
+LogSink& Log::AddSink(std::unique_ptr<LogSink> sink) {
+    std::lock_guard guard { sinksMutex_ };
+    return *sinks_.emplace_back(std::move(sink));
+}
+
+std::unique_ptr<LogSink> Log::RemoveSink(LogSink* sink) {
+    std::lock_guard guard { sinksMutex_ };
+    const auto it = std::ranges::find(sinks_, sink, &std::unique_ptr<LogSink>::get);
+    if(it == sinks_.end())
+        return nullptr;
+
+    Deliver(*sink);
+    auto removed = std::move(*it);
+    sinks_.erase(it);
+    if(fileSink_ == sink)
+        fileSink_ = nullptr;
+
+    return removed;
+}
+
+void Log::OpenBinaryLog(std::filesystem::path path) {
+    auto sink = std::make_unique<BinaryFileLogSink>(std::make_unique<BinaryLogFile>(std::move(path)), u8(Severity::MaxVal));
+    std::lock_guard guard { sinksMutex_ };
+    // Swapped in place so nothing written in between can miss the file
+    if(const auto it = std::ranges::find(sinks_, fileSink_, &std::unique_ptr<LogSink>::get); fileSink_ && it != sinks_.end()) {
+        Deliver(**it);
+        *it = std::move(sink);
+        fileSink_ = it->get();
+    }
+    else
+        fileSink_ = sinks_.emplace_back(std::move(sink)).get();
+}
+
+void Log::OpenCrashLog(const std::filesystem::path& path) {
+    auto ring = std::make_unique<MappedLogRing>(path);
+    if(!ring->isOpen()) {
+        const auto err = GetLastError();
+        LogWarn(L"Could not map crash log '{}', error 0x{:x}.", path.wstring(), u32(err));
+        return;
+    }
+
+    AddSink(std::make_unique<CrashRingLogSink>(std::move(ring), u8(Severity::MaxVal)));
+}
+
+void Log::WriteMessage(Severity sev, LogCategory cat, Timestamp::rep time, std::string_view message, const Record* source) {
+    if(sev == lastSeverity_ && cat == lastCategory_ && message == lastMessage_ && !lastMessage_.empty()) {
+        repeats_++;
+        lastTime_ = time;
+        return;
+    }
+
+    if(repeats_ > 0) {
+        Emit(lastSeverity_, lastCategory_, lastTime_, std::format("(repeated {} times)", repeats_));
+        repeats_ = 0;
+    }
+
+    Emit(sev, cat, time, message, source);
+    lastSeverity_ = sev;
+    lastCategory_ = cat;
+    lastTime_ = time;
+    lastMessage_.assign(message);
+}
+
+void Log::Emit(Severity sev, LogCategory cat, Timestamp::rep time, std::string_view message, const Record* source) {
+    LogEntry e { time, sev, cat, message };
+    if(source && source->formatter) {
+        e.formatter = source->formatter;
+        e.fmt = source->fmt;
+        e.fmtSize = source->fmtSize;
+        e.payload = source->data();
+    }
+
+    for(auto& sink : sinks_) {
+        if(!sink->Accepts(e))
+            continue;
+
+        if(sink->pending_.empty())
+            sink->deadline_ = std::chrono::steady_clock::now() + sink->policy().maxDelay;
+        sink->pending_.Add(e);
+        if(sink->pending_.size() >= sink->policy().maxEntries)
+            Deliver(*sink);
+    }
+}
+
+void Log::WriteSummaries() {
+    if(repeats_ > 0) {
+        Emit(lastSeverity_, lastCategory_, lastTime_, std::format("(repeated {} times)", repeats_));
+        repeats_ = 0;
+        // The next occurrence starts a new run rather than extending the reported one
+        lastMessage_.clear();
+    }
+
+    const auto now = Timestamp::clock::now().time_since_epoch().count();
+    for(auto* site = LogCallSite::suppressedSites_.load(std::memory_order_acquire); site; site = site->next_) {
+        if(const u32 n = site->suppressed_.exchange(0, std::memory_order_relaxed); n > 0)
+            Emit(site->sev_, site->cat_, now, std::format("{} messages suppressed from {}:{}", n, site->file_, site->line_));
+    }
+}
+
+void Log::Deliver(LogSink& sink) {
+    if(sink.pending_.empty())
+        return;
+
+    // A failing sink must not take the writer thread, and every other sink, down with it
+    try {
+        sink.Write(sink.pending_);
+    }
+    catch(...) { }
+    sink.pending_.Clear();
+}
+
+std::chrono::steady_clock::time_point Log::DeliverSinks(bool all) {
+    const auto now = std::chrono::steady_clock::now();
+    auto next = std::chrono::steady_clock::time_point::max();
+    for(auto& sink : sinks_) {
+        if(sink->pending_.empty())
+            continue;
+
+        if(all || now >= sink->deadline_)
+            Deliver(*sink);
+        else
+            next = std::min(next, sink->deadline_);
+    }
+    return next;
+}
 
 const char* Log::ToString(Severity sev) {
     switch(sev) {
@@ -157,6 +491,26 @@ const char* Log::ToString(Severity sev) {
     }
 }
 
+const char* Log::ToString(LogCategory cat) {
+    switch(cat) {
+    default:
+    case LogCategory::General:
+        return "General";
+    case LogCategory::Input:
+        return "Input";
+    case LogCategory::Shader:
+        return "Shader";
+    case LogCategory::FS:
+        return "File system";
+    case LogCategory::Config:
+        return "Config";
+    case LogCategory::Mumble:
+        return "Mumble";
+    case LogCategory::Graphics:
+        return "Graphics";
+    }
+}
+
 uint32_t Log::ToColor(Severity sev) {
     switch(sev) {
     default:
@@ -173,4 +527,9 @@ uint32_t Log::ToColor(Severity sev) {
 
 std::string Log::ToString(const Timestamp& t) { return std::format("[{:%T}", t); }
 
+std::string_view Log::ToString(const Timestamp& t, std::span<char> buffer) {
+    const auto r = std::format_to_n(buffer.data(), buffer.size(), "[{:%T}", t);
+    return { buffer.data(), size_t(r.out - buffer.data()) };
+}
+
 std::ofstream& Log::logStream() { return g_logStream; }
@@ -0,0 +1,79 @@
+#include "LogLineBuffer.h"
+
+LogLineBuffer::LogLineBuffer(size_t maxLines, size_t textCapacity)
+    : maxLines_(maxLines), textCapacity_(textCapacity), lines_(std::make_unique<Line[]>(maxLines)),
+      text_(std::make_unique<char[]>(textCapacity)) { }
+
+void LogLineBuffer::Push(i64 time, Severity sev, std::string_view text) {
+    if(text.size() > textCapacity_)
+        text = text.substr(0, textCapacity_);
+
+    // Lines are stored contiguously, skip the end of the slab if the text would wrap around
+    u64 pos = textHead_;
+    if(pos % textCapacity_ + text.size() > textCapacity_)
+        pos += textCapacity_ - pos % textCapacity_;
+    textHead_ = pos + text.size();
+
+    while(!empty() && (size() == maxLines_ || bySequence(tail_).textPos + textCapacity_ < textHead_))
+        PopFront();
+
+    memcpy(text_.get() + pos % textCapacity_, text.data(), text.size());
+    lines_[head_ % maxLines_] = { time, pos, u32(text.size()), sev };
+
+    for(u8 mask = 1; mask < AllSeverities; mask++) {
+        auto& idx = indices_[mask];
+        if(idx.sequences && (mask & u8(sev)) != 0)
+            idx.sequences[idx.head++ % maxLines_] = u32(head_);
+    }
+
+    head_++;
+}
+
+void LogLineBuffer::Clear() {
+    tail_ = head_;
+    for(auto& idx : indices_)
+        idx.tail = idx.head;
+}
+
+size_t LogLineBuffer::filteredSize(u8 mask) {
+    mask &= AllSeverities;
+    if(mask == AllSeverities)
+        return size();
+    if(mask == 0)
+        return 0;
+
+    return index(mask).size();
+}
+
+const LogLineBuffer::Line& LogLineBuffer::filtered(u8 mask, size_t i) {
+    mask &= AllSeverities;
+    if(mask == AllSeverities)
+        return (*this)[i];
+
+    const auto& idx = index(mask);
+    const u32 seq = idx.sequences[(idx.tail + i) % maxLines_];
+    return bySequence(tail_ + u32(seq - u32(tail_)));
+}
+
+void LogLineBuffer::PopFront() {
+    const Severity sev = bySequence(tail_).sev;
+    for(u8 mask = 1; mask < AllSeverities; mask++) {
+        auto& idx = indices_[mask];
+        if(idx.sequences && (mask & u8(sev)) != 0)
+            idx.tail++;
+    }
+
+    tail_++;
+}
+
+LogLineBuffer::MaskIndex& LogLineBuffer::index(u8 mask) {
+    auto& idx = indices_[mask];
+    if(!idx.sequences) {
+        idx.sequences = std::make_unique<u32[]>(maxLines_);
+        for(u64 seq = tail_; seq < head_; seq++)
+            if((mask & u8(bySequence(seq).sev)) != 0)
+                idx.sequences[idx.head++] = u32(seq);
+    }
+
+    return idx;
+}
@@ -0,0 +1,151 @@
+#include "LogSearch.h"
+
+#include <algorithm>
+
+#include "LogLineBuffer.h"
+
+namespace
+{
+char Fold(char c) {
+    return c >= 'A' && c <= 'Z' ? char(c - 'A' + 'a') : c;
+}
+
+u32 Trigram(const char* p) {
+    return u32(u8(Fold(p[0]))) << 16 | u32(u8(Fold(p[1]))) << 8 | u32(u8(Fold(p[2])));
+}
+}
+
+void LogSearch::Query(std::string_view query, Mode mode, u8 severityMask) {
+    std::string q(query);
+    if(mode == Mode::Substring)
+        std::ranges::transform(q, q.begin(), Fold);
+
+    if(q == query_ && mode == mode_ && severityMask == severityMask_)
+        return;
+
+    query_ = std::move(q);
+    mode_ = mode;
+    severityMask_ = severityMask;
+    regex_.reset();
+    dirty_ = true;
+
+    if(mode_ == Mode::Regex && !query_.empty()) {
+        try {
+            regex_.emplace(query_, std::regex::ECMAScript | std::regex::icase | std::regex::optimize);
+        }
+        catch(const std::regex_error&) { }
+    }
+}
+
+void LogSearch::Update(const LogLineBuffer& lines) {
+    const u64 first = lines.firstSequence();
+    const u64 end = lines.endSequence();
+
+    while(!matches_.empty() && matches_.front() < first)
+        matches_.pop_front();
+
+    if(!active()) {
+        matches_.clear();
+        return;
+    }
+
+    Index(lines, std::max(indexedEnd_, first), end);
+    if(first / BlockLines >= prunedBlock_ + PruneInterval)
+        Prune(first / BlockLines);
+
+    if(dirty_)
+        Rescan(lines);
+    else {
+        for(u64 seq = std::max(scannedEnd_, first); seq < end; seq++)
+            if(Matches(lines, seq))
+                matches_.push_back(seq);
+    }
+    scannedEnd_ = end;
+}
+
+void LogSearch::Index(const LogLineBuffer& lines, u64 begin, u64 end) {
+    for(u64 seq = begin; seq < end; seq++) {
+        const auto text = lines.text(lines.bySequence(seq));
+        if(text.size() < 3)
+            continue;
+
+        lineTrigrams_.clear();
+        for(size_t i = 0; i + 3 <= text.size(); i++)
+            lineTrigrams_.push_back(Trigram(text.data() + i));
+        std::ranges::sort(lineTrigrams_);
+        const auto dupes = std::ranges::unique(lineTrigrams_);
+        lineTrigrams_.erase(dupes.begin(), dupes.end());
+
+        const u64 block = seq / BlockLines;
+        for(u32 t : lineTrigrams_) {
+            auto& blocks = postings_[t];
+            if(blocks.empty() || blocks.back() != block)
+                blocks.push_back(block);
+        }
+    }
+    indexedEnd_ = std::max(indexedEnd_, end);
+}
+
+void LogSearch::Prune(u64 firstBlock) {
+    for(auto it = postings_.begin(); it != postings_.end();) {
+        auto& blocks = it->second;
+        blocks.erase(blocks.begin(), std::ranges::lower_bound(blocks, firstBlock));
+        it = blocks.empty() ? postings_.erase(it) : std::next(it);
+    }
+    prunedBlock_ = firstBlock;
+}
+
+void LogSearch::Rescan(const LogLineBuffer& lines) {
+    matches_.clear();
+    dirty_ = false;
+
+    const u64 first = lines.firstSequence();
+    const u64 end = lines.endSequence();
+
+    if(mode_ != Mode::Substring || query_.size() < 3) {
+        for(u64 seq = first; seq < end; seq++)
+            if(Matches(lines, seq))
+                matches_.push_back(seq);
+        return;
+    }
+
+    // Intersect the block lists of every trigram in the query, smallest first, then verify the surviving blocks
+    std::vector<const std::vector<u64>*> lists;
+    for(size_t i = 0; i + 3 <= query_.size(); i++) {
+        auto it = postings_.find(Trigram(query_.data() + i));
+        if(it == postings_.end())
+            return;
+        lists.push_back(&it->second);
+    }
+    std::ranges::sort(lists, {}, [](auto* l) { return l->size(); });
+
+    std::vector<u64> candidates(std::ranges::lower_bound(*lists.front(), first / BlockLines), lists.front()->end());
+    std::vector<u64> intersection;
+    for(size_t i = 1; i < lists.size() && !candidates.empty(); i++) {
+        if(lists[i] == lists[i - 1])
+            continue;
+
+        intersection.clear();
+        std::ranges::set_intersection(candidates, *lists[i], std::back_inserter(intersection));
+        candidates.swap(intersection);
+    }
+
+    for(u64 block : candidates) {
+        const u64 blockEnd = std::min((block + 1) * BlockLines, end);
+        for(u64 seq = std::max(block * BlockLines, first); seq < blockEnd; seq++)
+            if(Matches(lines, seq))
+                matches_.push_back(seq);
+    }
+}
+
+bool LogSearch::Matches(const LogLineBuffer& lines, u64 seq) const {
+    const auto& line = lines.bySequence(seq);
+    if((u8(line.sev) & severityMask_) == 0)
+        return false;
+
+    const auto text = lines.text(line);
+    if(mode_ == Mode::Regex)
+        return regex_ && std::regex_search(text.begin(), text.end(), *regex_);
+
+    return std::search(text.begin(), text.end(), query_.begin(), query_.end(), [](char a, char b) { return Fold(a) == b; }) != text.end();
+}
@@ -0,0 +1,133 @@
+#include "LogSink.h"
+
+#include "BinaryLogFile.h"
+#include "Log.h"
+#include "MappedLogRing.h"
+
+namespace
+{
+
+// Debuggers truncate long messages, so hand the batch over in line-aligned chunks
+void OutputDebugStringChunked(const std::string& text) {
+    constexpr size_t MaxChunk = 4000;
+    if(text.size() <= MaxChunk) {
+        OutputDebugStringA(text.c_str());
+        return;
+    }
+
+    std::string chunk;
+    for(size_t start = 0; start < text.size();) {
+        size_t end = start + MaxChunk;
+        if(end < text.size()) {
+            if(const size_t nl = text.rfind('\n', end); nl != std::string::npos && nl > start)
+                end = nl + 1;
+        }
+        else
+            end = text.size();
+
+        chunk.assign(text, start, end - start);
+        OutputDebugStringA(chunk.c_str());
+        start = end;
+    }
+}
+
+GW2Load_LogLevel ToLoaderLevel(Severity sev) {
+    switch(sev) {
+    case Severity::Debug:
+        return GW2Load_LogLevel::debug;
+    default:
+    case Severity::Info:
+        return GW2Load_LogLevel::info;
+    case Severity::Warn:
+        return GW2Load_LogLevel::warn;
+    case Severity::Error:
+        return GW2Load_LogLevel::err;
+    }
+}
+
+}
+
+void LogBatch::Add(const LogEntry& e) {
+    Stored s { e.time, e.sev, e.cat, u32(data_.size()), u32(e.message.size()), e.formatter, e.fmt, e.fmtSize, 0, u32(e.payload.size()) };
+    data_.append(e.message);
+    s.payloadOffset = u32(data_.size());
+    data_.append(e.payload);
+    entries_.push_back(s);
+}
+
+void LogBatch::Clear() {
+    entries_.clear();
+    data_.clear();
+}
+
+LogEntry LogBatch::operator[](size_t i) const {
+    const auto& s = entries_[i];
+    const std::string_view data(data_);
+    return { s.time, s.sev, s.cat, data.substr(s.messageOffset, s.messageSize), s.formatter, s.fmt, s.fmtSize, data.substr(s.payloadOffset, s.payloadSize) };
+}
+
+void LogSink::AppendLine(std::string& out, const LogEntry& e) {
+    char timeBuffer[32];
+    std::format_to(std::back_inserter(out), "{}{}{}\n", Log::ToString(Log::Timestamp(Log::Timestamp::duration(e.time)), timeBuffer),
+                   Log::ToString(e.sev), e.message);
+}
+
+TextFileLogSink::TextFileLogSink(std::ofstream& stream, u8 severities) : LogSink(severities), stream_(stream) { }
+
+void TextFileLogSink::Write(const LogBatch& batch) {
+    text_.clear();
+    batch.ForEach([&](const LogEntry& e) { AppendLine(text_, e); });
+    stream_ << text_;
+    stream_.flush();
+}
+
+DebuggerLogSink::DebuggerLogSink(u8 severities) : LogSink(severities) { }
+
+void DebuggerLogSink::Write(const LogBatch& batch) {
+    text_.clear();
+    batch.ForEach([&](const LogEntry& e) { AppendLine(text_, e); });
+    OutputDebugStringChunked(text_);
+}
+
+BinaryFileLogSink::BinaryFileLogSink(std::unique_ptr<BinaryLogFile> file, u8 severities) : LogSink(severities), file_(std::move(file)) { }
+
+BinaryFileLogSink::~BinaryFileLogSink() = default;
+
+void BinaryFileLogSink::Write(const LogBatch& batch) {
+    batch.ForEach([&](const LogEntry& e) {
+        if(e.formatter && e.formatter->binary)
+            file_->WriteMessage(e.time, e.sev, *e.formatter, e.fmt, e.fmtSize, e.payload);
+        else
+            file_->WriteText(e.time, e.sev, e.message);
+    });
+    file_->Flush();
+}
+
+// Entries are written one by one, anything held back would be lost in the crash the ring is meant to survive
+CrashRingLogSink::CrashRingLogSink(std::unique_ptr<MappedLogRing> ring, u8 severities)
+    : LogSink(severities, { .maxEntries = 1 }), ring_(std::move(ring)) { }
+
+CrashRingLogSink::~CrashRingLogSink() = default;
+
+void CrashRingLogSink::Write(const LogBatch& batch) {
+    batch.ForEach([&](const LogEntry& e) { ring_->Write(e.time, e.sev, e.message); });
+}
+
+// Resolved here rather than through GW2Load_API, older loaders do not export it at all
+LoaderLogSink::LoaderLogSink(HMODULE gw2loadHandle, u8 severities)
+    : LogSink(severities, { .maxEntries = 64, .maxDelay = std::chrono::milliseconds(250) }),
+      log_(reinterpret_cast<GW2Load_LogFunc>(GetProcAddress(gw2loadHandle, "GW2Load_Log"))) { }
+
+void LoaderLogSink::Write(const LogBatch& batch) {
+    if(!log_)
+        return;
+
+    batch.ForEach([&](const LogEntry& e) { log_(ToLoaderLevel(e.sev), e.message.data(), e.message.size()); });
+}
+
+CallbackLogSink::CallbackLogSink(Callback callback, u8 severities, BatchPolicy policy)
+    : LogSink(severities, policy), callback_(std::move(callback)) { }
+
+void CallbackLogSink::Write(const LogBatch& batch) {
+    callback_(batch);
+}
@@ -0,0 +1,90 @@
+#include "MappedLogRing.h"
+
+MappedLogRing::MappedLogRing(const std::filesystem::path& path, u64 capacity) : capacity_(capacity & ~(LogRing::Alignment - 1)) {
+    std::error_code ec;
+    if(std::filesystem::exists(path, ec)) {
+        auto prev = path;
+        prev += ".prev";
+        std::filesystem::rename(path, prev, ec);
+    }
+
+    file_ = CreateFileW(path.c_str(), GENERIC_READ | GENERIC_WRITE, FILE_SHARE_READ, nullptr, CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if(file_ == INVALID_HANDLE_VALUE)
+        return;
+
+    const u64 total = sizeof(LogRing::Header) + capacity_;
+    mapping_ = CreateFileMappingW(file_, nullptr, PAGE_READWRITE, DWORD(total >> 32), DWORD(total), nullptr);
+    if(!mapping_)
+        return;
+
+    auto* view = static_cast<char*>(MapViewOfFile(mapping_, FILE_MAP_WRITE, 0, 0, total));
+    if(!view)
+        return;
+
+    // A new mapping is zero-filled, so only the header needs setting up
+    header_ = reinterpret_cast<LogRing::Header*>(view);
+    records_ = view + sizeof(LogRing::Header);
+
+    using period = std::chrono::system_clock::period;
+    memcpy(header_->magic, LogRing::Magic, sizeof(header_->magic));
+    header_->version = LogRing::Version;
+    header_->headerSize = sizeof(LogRing::Header);
+    header_->capacity = capacity_;
+    header_->writeOffset = 0;
+    header_->nextSequence = 0;
+    header_->ticksPerSecond = period::den / period::num;
+}
+
+MappedLogRing::~MappedLogRing() {
+    if(header_)
+        UnmapViewOfFile(header_);
+    if(mapping_)
+        CloseHandle(mapping_);
+    if(file_ != INVALID_HANDLE_VALUE)
+        CloseHandle(file_);
+}
+
+void MappedLogRing::Write(i64 time, Severity sev, std::string_view text) {
+    if(!isOpen())
+        return;
+
+    // Keep single records small enough that a few long lines cannot wipe out the rest of the ring
+    text = text.substr(0, capacity_ / 16);
+
+    const u64 size = LogRing::RecordSize(text.size());
+    u64 pos = writeOffset_ % capacity_;
+    if(capacity_ - pos < size) {
+        const u64 remaining = capacity_ - pos;
+        if(remaining >= sizeof(LogRing::RecordHeader))
+            WriteRecord(pos, time, 0, LogRing::Padding, {}, u32(remaining - sizeof(LogRing::RecordHeader)));
+        writeOffset_ += remaining;
+        pos = 0;
+    }
+
+    WriteRecord(pos, time, u8(sev), 0, text, u32(text.size()));
+    writeOffset_ += size;
+
+    header_->writeOffset = writeOffset_;
+    header_->nextSequence = sequence_;
+}
+
+void MappedLogRing::WriteRecord(u64 offset, i64 time, u8 sev, u8 flags, std::string_view text, u32 size) {
+    auto* record = reinterpret_cast<LogRing::RecordHeader*>(records_ + offset);
+
+    // Only the compiler needs restraining: the ring is read back once this thread has stopped, so the magic just has
+    // to be cleared before and set after everything else is stored
+    record->magic = 0;
+    std::atomic_signal_fence(std::memory_order_seq_cst);
+
+    record->size = size;
+    record->sequence = sequence_++;
+    record->time = time;
+    record->severity = sev;
+    record->flags = flags;
+    record->reserved = 0;
+    record->reserved2 = 0;
+    memcpy(record + 1, text.data(), text.size());
+
+    std::atomic_signal_fence(std::memory_order_seq_cst);
+    record->magic = LogRing::RecordMagic;
+}
@@ -105,6 +105,7 @@ void WriteMiniDump(_EXCEPTION_POINTERS* pExceptionInfo) {
             while(std::filesystem::exists(szDumpPath));
 
             LogInfo(L"Writing minidump '{}'...", szDumpPath);
+            Log::i().Flush();
 
             // create the file
             HANDLE hFile = CreateFileW(szDumpPath, GENERIC_WRITE, FILE_SHARE_WRITE, nullptr, CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, nullptr);
@@ -21,6 +21,8 @@ void MiscTab::DrawMenu(Keybind**) {
 
     AdditionalGUI();
 
+    DrawEventProfiling();
+
 #ifdef _DEBUG
     const auto& pos = MumbleLink::i().position();
     ImGui::Text("position = %f, %f, %f", pos.x, pos.y, pos.z);
@@ -29,3 +31,53 @@ void MiscTab::DrawMenu(Keybind**) {
     ImGui::Text(dpiScaling ? "DPI scaling enabled" : "DPI scaling disabled");
 #endif
 }
+
+void MiscTab::DrawEventProfiling() {
+    if(!ImGui::CollapsingHeader("Event profiling"))
+        return;
+
+    bool enabled = ProfiledEvent::profilingEnabled();
+    if(ImGui::Checkbox("Record event listener timings", &enabled))
+        ProfiledEvent::profilingEnabled(enabled);
+
+    ImGui::SameLine();
+    if(ImGui::Button("Reset"))
+        ProfiledEvent::ForEach([](ProfiledEvent& e) { e.ResetStats(); });
+
+    if(!ImGui::BeginTable("EventProfiling", 6, ImGuiTableFlags_Borders | ImGuiTableFlags_RowBg | ImGuiTableFlags_SizingStretchProp))
+        return;
+
+    ImGui::TableSetupColumn("Event");
+    ImGui::TableSetupColumn("Listener");
+    ImGui::TableSetupColumn("Calls");
+    ImGui::TableSetupColumn("Total (ms)");
+    ImGui::TableSetupColumn("Mean (us)");
+    ImGui::TableSetupColumn("Max (us)");
+    ImGui::TableHeadersRow();
+
+    ProfiledEvent::ForEach([](ProfiledEvent& e) {
+        e.VisitCallbacks([&](const ProfiledEvent::CallbackInfo& cb) {
+            const u64 calls = cb.stats.calls.load(std::memory_order_relaxed);
+            const u64 totalNs = cb.stats.totalNs.load(std::memory_order_relaxed);
+
+            ImGui::TableNextRow();
+            ImGui::TableNextColumn();
+            ImGui::TextUnformatted(e.debugName().empty() ? "<unnamed>" : e.debugName().c_str());
+            ImGui::TableNextColumn();
+            if(cb.debugName.empty())
+                ImGui::Text("#%d (priority %d)", cb.id, cb.priority);
+            else
+                ImGui::Text("%s (#%d)", cb.debugName.c_str(), cb.id);
+            ImGui::TableNextColumn();
+            ImGui::Text("%llu", calls);
+            ImGui::TableNextColumn();
+            ImGui::Text("%.3f", f64(totalNs) * 1e-6);
+            ImGui::TableNextColumn();
+            ImGui::Text("%.2f", calls > 0 ? f64(totalNs) * 1e-3 / f64(calls) : 0.0);
+            ImGui::TableNextColumn();
+            ImGui::Text("%.2f", f64(cb.stats.maxNs.load(std::memory_order_relaxed)) * 1e-3);
+        });
+    });
+
+    ImGui::EndTable();
+}
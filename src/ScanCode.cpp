@@ -73,7 +73,7 @@ std::wstring GetScanCodeName(ScanCode scanCode) {
         return keyName;
     else {
         auto err = GetLastError();
-        Log::i().Print(Severity::Warn, L"Could not get key name for scan code 0x{:x}, error 0x{:x}.", u32(scanCode), u32(err));
+        LogWarnCat(Input, L"Could not get key name for scan code 0x{:x}, error 0x{:x}.", u32(scanCode), u32(err));
     }
 
     return L"[Error]";
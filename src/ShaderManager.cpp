@@ -18,10 +18,10 @@ public:
 
     HRESULT COM_DECLSPEC_NOTHROW Open([[maybe_unused]] D3D_INCLUDE_TYPE includeType, LPCSTR pFileName, [[maybe_unused]] LPCVOID pParentData,
                                       LPCVOID* ppData, UINT* pBytes) override {
-        LogDebug("Opening shader include '{}'...", pFileName);
+        LogDebugCat(Shader, "Opening shader include '{}'...", pFileName);
         auto file = ShaderManager::i().shadersZip_->getEntry(pFileName);
         if(file.isNull()) {
-            LogDebug("Include '{}' not found in archive!", pFileName);
+            LogDebugCat(Shader, "Include '{}' not found in archive!", pFileName);
             return E_INVALIDARG;
         }
 
@@ -61,7 +61,7 @@ void ShaderManager::SetShaders(ID3D11DeviceContext* ctx, ShaderId vs, ShaderId p
 
 ShaderId ShaderManager::GetShader(const std::wstring& filename, D3D11_SHADER_VERSION_TYPE st, const std::string& entrypoint,
                                   std::optional<std::vector<std::string>> macros) {
-    LogDebug(L"Looking for shader {}:{} (type #{})", filename, utf8_decode(entrypoint), i32(st));
+    LogDebugCat(Shader, L"Looking for shader {}:{} (type #{})", filename, utf8_decode(entrypoint), i32(st));
 
     for(u32 i = 0; i < shaders_.size(); i++) {
         auto& sd = shaders_[i];
@@ -93,15 +93,15 @@ void ShaderManager::ReloadAll() {
     LoadShadersArchive();
 
     if(hotReloadFolderExists_ && FileSystem::Exists(GetShaderFilename(filename))) {
-        LogDebug(L"Hot reloading shader file {}", filename);
+        LogDebugCat(Shader, L"Hot reloading shader file {}", filename);
         std::ifstream file(GetShaderFilename(filename));
         auto vec = FileSystem::ReadFile(file);
         return { reinterpret_cast<char*>(vec.data()), vec.size() };
     } else {
-        LogDebug(L"Looking for shader {} in archive", filename);
+        LogDebugCat(Shader, L"Looking for shader {} in archive", filename);
         auto file = shadersZip_->getEntry(EncodeShaderFilename(filename));
         if(file.isNull())
-            LogError(L"Shader file {} not found in archive!", filename);
+            LogErrorCat(Shader, L"Shader file {} not found in archive!", filename);
         GW2_ASSERT(!file.isNull());
 
         return FileSystem::ReadFileAsText(file);
@@ -109,7 +109,7 @@ void ShaderManager::ReloadAll() {
 }
 
 ComPtr<ID3D11Buffer> ShaderManager::MakeConstantBuffer(size_t dataSize, const void* data) const {
-    LogDebug("Creating constant buffer of {} bytes (initial data: {})", dataSize, data ? "yes" : "no");
+    LogDebugCat(Shader, "Creating constant buffer of {} bytes (initial data: {})", dataSize, data ? "yes" : "no");
 
     dataSize = RoundUp(dataSize, 16);
     D3D11_BUFFER_DESC desc { .ByteWidth = u32(dataSize),
@@ -129,12 +129,12 @@ static void HandleFailedShaderCompile(HRESULT hr, ID3DBlob* errors) {
     if(SUCCEEDED(hr))
         return;
 
-    LogError(L"Compilation failed: 0x{:x}", u32(hr));
+    LogErrorCat(Shader, L"Compilation failed: 0x{:x}", u32(hr));
 
     if(errors) {
         const char* errorsText = static_cast<const char*>(errors->GetBufferPointer());
 
-        LogError("Compilation errors:\n{}", errorsText);
+        LogErrorCat(Shader, "Compilation errors:\n{}", errorsText);
     }
 
 #ifndef _DEBUG
@@ -155,7 +155,7 @@ static void HandleFailedShaderCompile(HRESULT hr, ID3DBlob* errors) {
 [[nodiscard]] ShaderManager::AnyShaderComPtr ShaderManager::CompileShader(const std::wstring& filename, D3D11_SHADER_VERSION_TYPE st,
                                                                           const std::string& entrypoint,
                                                                           std::optional<std::vector<std::string>> macros) {
-    LogDebug(L"Compiling shader {}:{} (type #{})", filename, utf8_decode(entrypoint), i32(st));
+    LogDebugCat(Shader, L"Compiling shader {}:{} (type #{})", filename, utf8_decode(entrypoint), i32(st));
 
     ComPtr<ID3DBlob> blob = nullptr;
     while(blob == nullptr) {
@@ -204,7 +204,7 @@ void ShaderManager::LoadShadersArchive() {
     if(shadersZip_ || !shaderResourceID_)
         return;
 
-    LogDebug("Loading shader archive...");
+    LogDebugCat(Shader, "Loading shader archive...");
     const auto data = LoadResource(shaderResourceModule_, shaderResourceID_);
 
     shadersZip_ = ZipArchive::fromBuffer(data.data(), static_cast<u32>(data.size_bytes()));
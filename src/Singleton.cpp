@@ -1,21 +1,157 @@
 #include "Singleton.h"
 
+#include <algorithm>
+#include <execution>
+#include <string>
+
 SingletonManager g_singletonManagerInstance;
 
-BaseSingleton* BaseSingleton::Store(std::unique_ptr<BaseSingleton>&& ptr) {
-    g_singletonManagerInstance.singletons_.push(std::move(ptr));
-    return g_singletonManagerInstance.singletons_.top().get();
+BaseSingleton* BaseSingleton::Store(std::unique_ptr<BaseSingleton>&& ptr, const char* name, std::span<const InstanceFn> dependencies) {
+    ptr->name_ = name;
+    ptr->dependencies_ = dependencies;
+
+    std::lock_guard guard { g_singletonManagerInstance.mutex_ };
+    auto* s = ptr.release();
+    g_singletonManagerInstance.Link(s);
+    return s;
+}
+
+void BaseSingleton::Clear(BaseSingleton* ptr) {
+    {
+        std::lock_guard guard { g_singletonManagerInstance.mutex_ };
+        if(!ptr->linked_)
+            return;
+        g_singletonManagerInstance.Unlink(ptr);
+    }
+
+    // Destroyed outside the lock, destructors may reset other singletons
+    delete ptr;
+}
+
+void SingletonManager::Link(BaseSingleton* s) {
+    s->prev_ = tail_;
+    s->next_ = nullptr;
+    s->linked_ = true;
+    if(tail_)
+        tail_->next_ = s;
+    else
+        head_ = s;
+    tail_ = s;
 }
 
-void BaseSingleton::Clear(BaseSingleton* clearPtr) {
-    std::stack<std::unique_ptr<BaseSingleton>> singletons;
+void SingletonManager::Unlink(BaseSingleton* s) {
+    if(s->prev_)
+        s->prev_->next_ = s->next_;
+    else
+        head_ = s->next_;
+    if(s->next_)
+        s->next_->prev_ = s->prev_;
+    else
+        tail_ = s->prev_;
+
+    s->prev_ = s->next_ = nullptr;
+    s->linked_ = false;
+}
+
+bool SingletonManager::HasDependents(const BaseSingleton* s) const {
+    for(auto* other = head_; other; other = other->next_) {
+        if(other != s && std::ranges::any_of(other->dependencies_, [s](auto instance) { return instance() == s; }))
+            return true;
+    }
+    return false;
+}
+
+void SingletonManager::Shutdown(const DestroyedCallback& onDestroyed) {
+    for(;;) {
+        BaseSingleton* s = nullptr;
+        {
+            std::lock_guard guard { mutex_ };
+            if(!tail_)
+                break;
+
+            for(auto* candidate = tail_; candidate && !s; candidate = candidate->prev_) {
+                if(!HasDependents(candidate))
+                    s = candidate;
+            }
+            // Only possible with circular dependencies, fall back to plain LIFO
+            if(!s)
+                s = tail_;
+
+            Unlink(s);
+        }
+
+        const char* name = s->name_;
+        const auto start = std::chrono::steady_clock::now();
+        delete s;
+        const auto duration = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start);
+
+        if(onDestroyed)
+            onDestroyed(name, duration);
+    }
+}
+
+size_t SingletonInitializer::Wave(size_t node, std::vector<size_t>& waves, std::vector<bool>& visiting) const {
+    constexpr size_t Unknown = ~size_t(0);
+    if(waves[node] != Unknown)
+        return waves[node];
+    if(visiting[node])
+        throw std::logic_error(std::string("Singleton dependency cycle involving ") + nodes_[node].name);
+
+    visiting[node] = true;
+    size_t wave = 0;
+    for(size_t dependency : nodes_[node].dependencies)
+        wave = std::max(wave, Wave(dependency, waves, visiting) + 1);
+    visiting[node] = false;
+
+    return waves[node] = wave;
+}
+
+std::vector<SingletonInitializer::Result> SingletonInitializer::Run() {
+    std::vector<size_t> waves(nodes_.size(), ~size_t(0));
+    std::vector<bool> visiting(nodes_.size(), false);
+    size_t waveCount = 0;
+    for(size_t i = 0; i < nodes_.size(); i++)
+        waveCount = std::max(waveCount, Wave(i, waves, visiting) + 1);
+
+    std::vector<Result> results(nodes_.size());
+    // Not vector<bool>, nodes of the same wave are written concurrently
+    std::vector<char> failed(nodes_.size(), false);
+    auto construct = [&](size_t i) {
+        const auto& node = nodes_[i];
+        auto& result = results[i];
+        result.name = node.name;
+        result.wave = waves[i];
+
+        if(std::ranges::any_of(node.dependencies, [&](size_t d) { return failed[d] != 0; })) {
+            result.error = std::make_exception_ptr(std::runtime_error("A dependency failed to initialize."));
+            failed[i] = true;
+            return;
+        }
+
+        const auto start = std::chrono::steady_clock::now();
+        try {
+            node.construct();
+        }
+        catch(...) {
+            result.error = std::current_exception();
+            failed[i] = true;
+        }
+        result.duration = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start);
+    };
+
+    std::vector<size_t> concurrent, serial;
+    for(size_t w = 0; w < waveCount; w++) {
+        concurrent.clear();
+        serial.clear();
+        for(size_t i = 0; i < nodes_.size(); i++) {
+            if(waves[i] == w)
+                (nodes_[i].concurrent ? concurrent : serial).push_back(i);
+        }
 
-    while(!g_singletonManagerInstance.singletons_.empty()) {
-        auto ptr = std::move(g_singletonManagerInstance.singletons_.top());
-        g_singletonManagerInstance.singletons_.pop();
-        if(ptr.get() != clearPtr)
-            singletons.push(std::move(ptr));
+        std::for_each(std::execution::par, concurrent.begin(), concurrent.end(), construct);
+        std::ranges::for_each(serial, construct);
     }
 
-    std::swap(singletons, g_singletonManagerInstance.singletons_);
+    nodes_.clear();
+    return results;
 }
@@ -72,9 +72,7 @@ std::filesystem::path GetGameFolder() {
     std::wstring exeFolder;
     SplitFilename(exeFullPath, &exeFolder, nullptr);
 
-#if _DEBUG
-    Log::i().Print(Severity::Debug, L"Game folder path: {}", exeFolder.c_str());
-#endif
+    LogDebugCat(FS, L"Game folder path: {}", exeFolder.c_str());
 
     return exeFolder;
 }
@@ -87,9 +85,7 @@ std::optional<std::filesystem::path> GetDocumentsFolder() {
     std::filesystem::path documentsGW2 = myDocuments;
     documentsGW2 /= L"GUILD WARS 2";
 
-#if _DEBUG
-    Log::i().Print(Severity::Debug, L"Documents folder path: {}", documentsGW2.c_str());
-#endif
+    LogDebugCat(FS, L"Documents folder path: {}", documentsGW2.c_str());
 
     if(std::filesystem::is_directory(documentsGW2))
         return documentsGW2;
@@ -97,7 +93,7 @@ std::optional<std::filesystem::path> GetDocumentsFolder() {
     if(SUCCEEDED(SHCreateDirectoryExW(nullptr, documentsGW2.c_str(), nullptr)))
         return documentsGW2;
 
-    Log::i().Print(Severity::Warn, L"Could not open or create documents folder '{}'.", documentsGW2.wstring());
+    LogWarnCat(FS, L"Could not open or create documents folder '{}'.", documentsGW2.wstring());
 
     return std::nullopt;
 }
@@ -105,7 +101,7 @@ std::optional<std::filesystem::path> GetDocumentsFolder() {
 std::optional<std::filesystem::path> GetAddonFolder() {
     auto folder = (GetGameFolder() / L"addons" / ToLower(AddonNameW)).make_preferred();
 
-    LogDebug(L"Addons folder path: {}", folder.c_str());
+    LogDebugCat(FS, L"Addons folder path: {}", folder.c_str());
 
     if(std::filesystem::is_directory(folder))
         return folder;
@@ -113,11 +109,11 @@ std::optional<std::filesystem::path> GetAddonFolder() {
     if(SUCCEEDED(SHCreateDirectoryExW(nullptr, folder.c_str(), nullptr)))
         return folder;
 
-    LogWarn(L"Could not open or create configuration folder '{}'.", folder.wstring());
+    LogWarnCat(FS, L"Could not open or create configuration folder '{}'.", folder.wstring());
 
     auto docs = GetDocumentsFolder();
     if(!docs) {
-        LogError(L"Could not locate Documents folder (fallback).");
+        LogErrorCat(FS, L"Could not locate Documents folder (fallback).");
         return std::nullopt;
     }
 
@@ -129,7 +125,7 @@ std::optional<std::filesystem::path> GetAddonFolder() {
     if(SUCCEEDED(SHCreateDirectoryExW(nullptr, folder.c_str(), nullptr)))
         return folder;
 
-    LogError(L"Could not open or create configuration folder '{}'.", folder.wstring());
+    LogErrorCat(FS, L"Could not open or create configuration folder '{}'.", folder.wstring());
 
     return std::nullopt;
 }
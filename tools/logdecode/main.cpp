@@ -0,0 +1,345 @@
+// Decodes binary addon logs (see include/LogFileFormat.h) back to the text format of the regular log files.
+// Rotated segments are zip archives and need to be extracted first.
+//
+// Usage: logdecode [--min-severity debug|info|warn|error] <file.gw2log|->...
+
+#include <LogFileFormat.h>
+
+#include <fmt/args.h>
+#include <fmt/format.h>
+
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace
+{
+struct FormatDef
+{
+    std::vector<LogFile::ArgType> args;
+    std::string format;
+};
+
+class Reader
+{
+public:
+    explicit Reader(std::string_view data) : data_(data) { }
+
+    [[nodiscard]] bool empty() const { return pos_ >= data_.size(); }
+    [[nodiscard]] size_t offset() const { return pos_; }
+
+    template<typename T>
+    bool Read(T& out) {
+        if(data_.size() - pos_ < sizeof(T))
+            return false;
+        memcpy(&out, data_.data() + pos_, sizeof(T));
+        pos_ += sizeof(T);
+        return true;
+    }
+
+    bool Read(std::string_view& out, size_t size) {
+        if(data_.size() - pos_ < size)
+            return false;
+        out = data_.substr(pos_, size);
+        pos_ += size;
+        return true;
+    }
+
+    [[nodiscard]] LogFile::RecordType PeekType() const { return LogFile::RecordType(data_[pos_]); }
+
+private:
+    std::string_view data_;
+    size_t pos_ = 0;
+};
+
+void AppendUtf8(std::string& out, char32_t c) {
+    if(c < 0x80)
+        out += char(c);
+    else if(c < 0x800) {
+        out += char(0xC0 | (c >> 6));
+        out += char(0x80 | (c & 0x3F));
+    }
+    else if(c < 0x10000) {
+        out += char(0xE0 | (c >> 12));
+        out += char(0x80 | ((c >> 6) & 0x3F));
+        out += char(0x80 | (c & 0x3F));
+    }
+    else {
+        out += char(0xF0 | (c >> 18));
+        out += char(0x80 | ((c >> 12) & 0x3F));
+        out += char(0x80 | ((c >> 6) & 0x3F));
+        out += char(0x80 | (c & 0x3F));
+    }
+}
+
+// Wide strings are UTF-16 when written on Windows, UTF-32 otherwise
+std::string WideToUtf8(std::string_view bytes, uint8_t wcharSize) {
+    std::string out;
+    const size_t count = bytes.size() / wcharSize;
+    for(size_t i = 0; i < count; i++) {
+        char32_t c = 0;
+        memcpy(&c, bytes.data() + i * wcharSize, wcharSize);
+        if(wcharSize == 2 && c >= 0xD800 && c < 0xDC00 && i + 1 < count) {
+            char32_t low = 0;
+            memcpy(&low, bytes.data() + (i + 1) * wcharSize, wcharSize);
+            if(low >= 0xDC00 && low < 0xE000) {
+                c = 0x10000 + ((c - 0xD800) << 10) + (low - 0xDC00);
+                i++;
+            }
+        }
+        AppendUtf8(out, c);
+    }
+    return out;
+}
+
+template<typename T>
+bool PushScalar(Reader& r, fmt::dynamic_format_arg_store<fmt::format_context>& store) {
+    T v;
+    if(!r.Read(v))
+        return false;
+    store.push_back(v);
+    return true;
+}
+
+bool PushArg(Reader& r, LogFile::ArgType type, const LogFile::FileHeader& header, fmt::dynamic_format_arg_store<fmt::format_context>& store) {
+    using enum LogFile::ArgType;
+    switch(type) {
+    case Bool:
+        return PushScalar<bool>(r, store);
+    case Char:
+        return PushScalar<char>(r, store);
+    case WChar: {
+        std::string_view bytes;
+        if(!r.Read(bytes, header.wcharSize))
+            return false;
+        store.push_back(WideToUtf8(bytes, header.wcharSize));
+        return true;
+    }
+    case Int8:
+        return PushScalar<int8_t>(r, store);
+    case UInt8:
+        return PushScalar<uint8_t>(r, store);
+    case Int16:
+        return PushScalar<int16_t>(r, store);
+    case UInt16:
+        return PushScalar<uint16_t>(r, store);
+    case Int32:
+        return PushScalar<int32_t>(r, store);
+    case UInt32:
+        return PushScalar<uint32_t>(r, store);
+    case Int64:
+        return PushScalar<int64_t>(r, store);
+    case UInt64:
+        return PushScalar<uint64_t>(r, store);
+    case Float:
+        return PushScalar<float>(r, store);
+    case Double:
+        return PushScalar<double>(r, store);
+    case Pointer: {
+        uint64_t p = 0;
+        std::string_view bytes;
+        if(!r.Read(bytes, header.pointerSize))
+            return false;
+        memcpy(&p, bytes.data(), std::min<size_t>(bytes.size(), sizeof(p)));
+        store.push_back(reinterpret_cast<const void*>(uintptr_t(p)));
+        return true;
+    }
+    case String:
+    case WString: {
+        uint32_t len;
+        std::string_view bytes;
+        if(!r.Read(len) || !r.Read(bytes, size_t(len) * (type == WString ? header.wcharSize : 1)))
+            return false;
+        store.push_back(type == WString ? WideToUtf8(bytes, header.wcharSize) : std::string(bytes));
+        return true;
+    }
+    default:
+        return false;
+    }
+}
+
+const char* SeverityLabel(uint8_t sev) {
+    switch(sev) {
+    case 1:
+        return "|DBG] ";
+    case 2:
+        return "|INF] ";
+    case 4:
+        return "|WRN] ";
+    case 8:
+        return "|ERR] ";
+    default:
+        return "|???] ";
+    }
+}
+
+std::string FormatTime(int64_t ticks, int64_t ticksPerSecond) {
+    const int64_t secondsPerDay = 24 * 60 * 60;
+    int64_t seconds = ticks / ticksPerSecond;
+    int64_t fraction = ticks % ticksPerSecond;
+    if(fraction < 0) {
+        fraction += ticksPerSecond;
+        seconds--;
+    }
+    const int64_t daySeconds = ((seconds % secondsPerDay) + secondsPerDay) % secondsPerDay;
+
+    int digits = 0;
+    for(int64_t t = ticksPerSecond; t > 1; t /= 10)
+        digits++;
+
+    if(digits == 0)
+        return fmt::format("[{:02}:{:02}:{:02}", daySeconds / 3600, daySeconds / 60 % 60, daySeconds % 60);
+    return fmt::format("[{:02}:{:02}:{:02}.{:0{}}", daySeconds / 3600, daySeconds / 60 % 60, daySeconds % 60, fraction, digits);
+}
+
+bool Decode(std::string_view data, const std::string& name, uint8_t minSeverity) {
+    Reader r(data);
+    LogFile::FileHeader header;
+    if(!r.Read(header) || memcmp(header.magic, LogFile::Magic, sizeof(header.magic)) != 0) {
+        std::cerr << name << ": not a binary log file\n";
+        return false;
+    }
+    if(header.version != LogFile::Version) {
+        std::cerr << name << ": unsupported version " << header.version << "\n";
+        return false;
+    }
+    if(header.ticksPerSecond <= 0 || header.wcharSize == 0 || header.wcharSize > 4) {
+        std::cerr << name << ": corrupt header\n";
+        return false;
+    }
+
+    std::unordered_map<uint32_t, FormatDef> defs;
+    std::string line;
+    while(!r.empty()) {
+        const size_t recordOffset = r.offset();
+        bool ok = true;
+
+        switch(r.PeekType()) {
+        case LogFile::RecordType::FormatDef: {
+            LogFile::FormatDefHeader h;
+            std::string_view types, format;
+            ok = r.Read(h) && r.Read(types, h.argCount) && r.Read(format, h.formatSize);
+            if(ok) {
+                auto& def = defs[h.id];
+                def.args.assign(reinterpret_cast<const LogFile::ArgType*>(types.data()),
+                                reinterpret_cast<const LogFile::ArgType*>(types.data() + types.size()));
+                def.format = format;
+            }
+            break;
+        }
+        case LogFile::RecordType::Message: {
+            LogFile::MessageHeader h;
+            std::string_view payload;
+            ok = r.Read(h) && r.Read(payload, h.payloadSize);
+            if(!ok || h.severity < minSeverity)
+                break;
+
+            line.clear();
+            auto def = defs.find(h.formatId);
+            if(def == defs.end())
+                line = fmt::format("<undefined format {}>", h.formatId);
+            else {
+                Reader args(payload);
+                fmt::dynamic_format_arg_store<fmt::format_context> store;
+                bool argsOk = true;
+                for(auto type : def->second.args)
+                    argsOk = argsOk && PushArg(args, type, header, store);
+
+                if(!argsOk)
+                    line = fmt::format("<malformed arguments for '{}'>", def->second.format);
+                else {
+                    try {
+                        line = fmt::vformat(def->second.format, store);
+                    }
+                    catch(const fmt::format_error& e) {
+                        line = fmt::format("<format error '{}': {}>", def->second.format, e.what());
+                    }
+                }
+            }
+            std::cout << FormatTime(h.time, header.ticksPerSecond) << SeverityLabel(h.severity) << line << '\n';
+            break;
+        }
+        case LogFile::RecordType::Text: {
+            LogFile::TextHeader h;
+            std::string_view text;
+            ok = r.Read(h) && r.Read(text, h.size);
+            if(ok && h.severity >= minSeverity)
+                std::cout << FormatTime(h.time, header.ticksPerSecond) << SeverityLabel(h.severity) << text << '\n';
+            break;
+        }
+        default:
+            std::cerr << name << ": unknown record type " << int(r.PeekType()) << " at offset " << recordOffset << "\n";
+            return false;
+        }
+
+        // The last record may be incomplete if the game crashed or is still running
+        if(!ok) {
+            std::cerr << name << ": truncated record at offset " << recordOffset << "\n";
+            return false;
+        }
+    }
+
+    return true;
+}
+
+std::optional<uint8_t> ParseSeverity(std::string_view s) {
+    if(s == "debug")
+        return 1;
+    if(s == "info")
+        return 2;
+    if(s == "warn")
+        return 4;
+    if(s == "error")
+        return 8;
+    return std::nullopt;
+}
+} // namespace
+
+int main(int argc, char** argv) {
+    uint8_t minSeverity = 0;
+    std::vector<std::string> files;
+    for(int i = 1; i < argc; i++) {
+        std::string_view arg = argv[i];
+        if(arg == "--min-severity" && i + 1 < argc) {
+            auto sev = ParseSeverity(argv[++i]);
+            if(!sev) {
+                std::cerr << "unknown severity '" << argv[i] << "'\n";
+                return 2;
+            }
+            minSeverity = *sev;
+        }
+        else
+            files.emplace_back(arg);
+    }
+
+    if(files.empty()) {
+        std::cerr << "usage: " << argv[0] << " [--min-severity debug|info|warn|error] <file.gw2log|->...\n";
+        return 2;
+    }
+
+    bool ok = true;
+    for(const auto& name : files) {
+        std::string data;
+        if(name == "-")
+            data.assign(std::istreambuf_iterator<char>(std::cin), {});
+        else {
+            std::ifstream in(name, std::ios::binary);
+            if(!in) {
+                std::cerr << name << ": cannot open\n";
+                ok = false;
+                continue;
+            }
+            data.assign(std::istreambuf_iterator<char>(in), {});
+        }
+
+        ok = Decode(data, name, minSeverity) && ok;
+    }
+
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,141 @@
+// Reconstructs the log tail from a crash log ring (see LogRing in include/LogFileFormat.h). The ring of the
+// previous session is kept as <addon>.ring.prev once the game is restarted.
+//
+// Usage: logring <file.ring>
+
+#include <LogFileFormat.h>
+
+#include <algorithm>
+#include <cinttypes>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace
+{
+struct Record
+{
+    uint64_t sequence;
+    int64_t time;
+    uint8_t severity;
+    uint8_t flags;
+    std::string_view text;
+};
+
+const char* SeverityLabel(uint8_t sev) {
+    switch(sev) {
+    case 1:
+        return "|DBG] ";
+    case 2:
+        return "|INF] ";
+    case 4:
+        return "|WRN] ";
+    case 8:
+        return "|ERR] ";
+    default:
+        return "|???] ";
+    }
+}
+
+std::string FormatTime(int64_t ticks, int64_t ticksPerSecond) {
+    const int64_t secondsPerDay = 24 * 60 * 60;
+    int64_t seconds = ticks / ticksPerSecond;
+    int64_t fraction = ticks % ticksPerSecond;
+    if(fraction < 0) {
+        fraction += ticksPerSecond;
+        seconds--;
+    }
+    const int64_t daySeconds = ((seconds % secondsPerDay) + secondsPerDay) % secondsPerDay;
+
+    int digits = 0;
+    for(int64_t t = ticksPerSecond; t > 1; t /= 10)
+        digits++;
+
+    char buf[64];
+    snprintf(buf, sizeof(buf), "[%02" PRId64 ":%02" PRId64 ":%02" PRId64, daySeconds / 3600, daySeconds / 60 % 60, daySeconds % 60);
+    std::string out = buf;
+    if(digits > 0) {
+        snprintf(buf, sizeof(buf), ".%0*" PRId64, digits, fraction);
+        out += buf;
+    }
+    return out;
+}
+} // namespace
+
+int main(int argc, char** argv) {
+    if(argc != 2) {
+        std::cerr << "usage: " << argv[0] << " <file.ring>\n";
+        return 2;
+    }
+
+    std::ifstream in(argv[1], std::ios::binary);
+    if(!in) {
+        std::cerr << argv[1] << ": cannot open\n";
+        return 1;
+    }
+    const std::string data(std::istreambuf_iterator<char>(in), {});
+
+    LogRing::Header header;
+    if(data.size() < sizeof(header)) {
+        std::cerr << argv[1] << ": not a crash log ring\n";
+        return 1;
+    }
+    memcpy(&header, data.data(), sizeof(header));
+    if(memcmp(header.magic, LogRing::Magic, sizeof(header.magic)) != 0 || header.version != LogRing::Version) {
+        std::cerr << argv[1] << ": not a crash log ring or unsupported version\n";
+        return 1;
+    }
+    if(header.headerSize < sizeof(header) || header.ticksPerSecond <= 0 || data.size() < header.headerSize ||
+       data.size() - header.headerSize < header.capacity) {
+        std::cerr << argv[1] << ": corrupt header or truncated file\n";
+        return 1;
+    }
+
+    const std::string_view ring(data.data() + header.headerSize, header.capacity);
+
+    // Records are contiguous within each pass over the ring, but the write position usually lands in the middle of an
+    // older record, so resynchronize on the next aligned record magic whenever parsing fails
+    std::vector<Record> records;
+    for(uint64_t pos = 0; pos + sizeof(LogRing::RecordHeader) <= ring.size();) {
+        LogRing::RecordHeader h;
+        memcpy(&h, ring.data() + pos, sizeof(h));
+
+        const uint64_t size = LogRing::RecordSize(h.size);
+        // The header is updated after each record, so the last record may be one ahead of it
+        if(h.magic != LogRing::RecordMagic || size > ring.size() - pos || h.sequence > header.nextSequence) {
+            pos += LogRing::Alignment;
+            continue;
+        }
+
+        records.push_back({ h.sequence, h.time, h.severity, h.flags, ring.substr(pos + sizeof(h), h.size) });
+        pos += size;
+    }
+
+    if(records.empty()) {
+        std::cerr << argv[1] << ": no records\n";
+        return 0;
+    }
+
+    std::ranges::sort(records, {}, &Record::sequence);
+
+    // Only the run of consecutive sequence numbers ending at the newest record is known to be intact
+    size_t first = records.size() - 1;
+    while(first > 0 && records[first - 1].sequence + 1 == records[first].sequence)
+        first--;
+    if(first > 0)
+        std::cerr << argv[1] << ": skipped " << first << " older records preceding a gap\n";
+
+    for(size_t i = first; i < records.size(); i++) {
+        const auto& r = records[i];
+        if(r.flags & LogRing::Padding)
+            continue;
+        std::cout << FormatTime(r.time, header.ticksPerSecond) << SeverityLabel(r.severity) << r.text << '\n';
+    }
+
+    return 0;
+}
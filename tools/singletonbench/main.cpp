@@ -0,0 +1,110 @@
+// Compares the cost of Singleton<T>::i() (include/Singleton.h) against the previous unsynchronized implementation,
+// which checked a plain bool and pointer. Accessors are kept out of line, as calls from other translation units are.
+//
+// Usage: singletonbench [iterations]
+// Exits with 1 if the current implementation is more than 10% slower single-threaded.
+
+#include <Singleton.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#if defined(_MSC_VER)
+#define BENCH_NOINLINE __declspec(noinline)
+#else
+#define BENCH_NOINLINE [[gnu::noinline]]
+#endif
+
+namespace
+{
+// Singleton<T>::i() as it was before access was made thread-safe
+template<typename T>
+class LegacySingleton
+{
+public:
+    static T& i() {
+        if(!init_) {
+            init_ = true;
+            i_ = new T();
+        }
+        return *i_;
+    }
+
+private:
+    inline static bool init_ = false;
+    inline static T* i_ = nullptr;
+};
+
+struct LegacyTarget : LegacySingleton<LegacyTarget>
+{
+    uint64_t value = 1;
+};
+
+struct Target : Singleton<Target>
+{
+    uint64_t value = 1;
+};
+
+BENCH_NOINLINE uint64_t ReadLegacy() { return LegacyTarget::i().value; }
+BENCH_NOINLINE uint64_t ReadCurrent() { return Target::i().value; }
+
+template<typename F>
+double NanosecondsPerCall(F read, uint64_t iterations, uint64_t& sink) {
+    // Best of several runs, to keep scheduling noise out
+    double best = 1e300;
+    for(int run = 0; run < 5; run++) {
+        const auto start = std::chrono::steady_clock::now();
+        uint64_t sum = 0;
+        for(uint64_t n = 0; n < iterations; n++)
+            sum += read();
+        const std::chrono::duration<double, std::nano> elapsed = std::chrono::steady_clock::now() - start;
+        sink += sum;
+        best = std::min(best, elapsed.count() / double(iterations));
+    }
+    return best;
+}
+} // namespace
+
+int main(int argc, char** argv) {
+    const uint64_t iterations = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 100'000'000;
+    uint64_t sink = 0;
+
+    // Construct both up front, only the fast path is of interest
+    ReadLegacy();
+    ReadCurrent();
+
+    const double legacy = NanosecondsPerCall(ReadLegacy, iterations, sink);
+    const double current = NanosecondsPerCall(ReadCurrent, iterations, sink);
+    std::printf("single thread: legacy %.3f ns/call, current %.3f ns/call (%+.1f%%)\n", legacy, current, (current / legacy - 1.0) * 100.0);
+
+    // The legacy version is not safe to share between threads, so only the current one is measured here
+    const unsigned threads = std::max(2u, std::thread::hardware_concurrency());
+    std::vector<double> perThread(threads);
+    {
+        std::vector<std::jthread> workers;
+        for(unsigned t = 0; t < threads; t++)
+            workers.emplace_back([&, t] {
+                uint64_t local = 0;
+                perThread[t] = NanosecondsPerCall(ReadCurrent, iterations / threads, local);
+                if(local == 0)
+                    std::abort();
+            });
+    }
+    std::printf("%u threads: current %.3f ns/call (slowest thread)\n", threads, *std::ranges::max_element(perThread));
+
+    g_singletonManagerInstance.Shutdown();
+    if(sink == 0)
+        std::abort();
+
+    if(current > legacy * 1.10) {
+        std::printf("regression: current implementation is more than 10%% slower\n");
+        return 1;
+    }
+    return 0;
+}